@@ -0,0 +1,125 @@
+#include "AVFrameVideoBuffer.h"
+
+// 32λRGBʽСֽӦ
+static const struct
+{
+	AVPixelFormat avFormat;
+	QVideoFrame::PixelFormat qtFormat;
+} PIXEL_FORMAT_MAP[] = {
+	{ AV_PIX_FMT_YUV420P, QVideoFrame::Format_YUV420P },
+	{ AV_PIX_FMT_NV12, QVideoFrame::Format_NV12 },
+	{ AV_PIX_FMT_NV21, QVideoFrame::Format_NV21 },
+	{ AV_PIX_FMT_YUV422P, QVideoFrame::Format_YUV422P },
+	{ AV_PIX_FMT_UYVY422, QVideoFrame::Format_UYVY },
+	{ AV_PIX_FMT_YUYV422, QVideoFrame::Format_YUYV },
+	{ AV_PIX_FMT_BGR0, QVideoFrame::Format_RGB32 },
+	{ AV_PIX_FMT_BGRA, QVideoFrame::Format_ARGB32 },
+	{ AV_PIX_FMT_RGB24, QVideoFrame::Format_RGB24 },
+};
+
+AVFrameVideoBuffer::AVFrameVideoBuffer(const AVFrame* frame)
+	: QAbstractVideoBuffer(NoHandle)
+{
+	m_frame = av_frame_clone(frame);
+}
+
+AVFrameVideoBuffer::~AVFrameVideoBuffer()
+{
+	av_frame_free(&m_frame);
+}
+
+QAbstractVideoBuffer::MapMode AVFrameVideoBuffer::mapMode() const
+{
+	return m_mapMode;
+}
+
+uchar* AVFrameVideoBuffer::map(MapMode mode, int* numBytes, int* bytesPerLine)
+{
+	int lines[4] = { 0 };
+	uchar* data[4] = { nullptr };
+	if (mapPlanes(mode, numBytes, lines, data) <= 0)
+	{
+		return nullptr;
+	}
+	if (bytesPerLine)
+	{
+		*bytesPerLine = lines[0];
+	}
+	return data[0];
+}
+
+int AVFrameVideoBuffer::mapPlanes(MapMode mode, int* numBytes, int bytesPerLine[4], uchar* data[4])
+{
+	// frameԱãֻֻӳ
+	if (!m_frame || m_mapMode != NotMapped || mode != ReadOnly)
+	{
+		return 0;
+	}
+	int planes = av_pix_fmt_count_planes((AVPixelFormat)m_frame->format);
+	if (planes <= 0)
+	{
+		return 0;
+	}
+	planes = FFMIN(planes, 4);
+	for (int i = 0; i < planes; ++i)
+	{
+		bytesPerLine[i] = m_frame->linesize[i];
+		data[i] = m_frame->data[i];
+	}
+	if (numBytes)
+	{
+		*numBytes = totalBytes();
+	}
+	m_mapMode = mode;
+	return planes;
+}
+
+void AVFrameVideoBuffer::unmap()
+{
+	m_mapMode = NotMapped;
+}
+
+int AVFrameVideoBuffer::planeHeight(int plane) const
+{
+	const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get((AVPixelFormat)m_frame->format);
+	if (desc && (plane == 1 || plane == 2))
+	{
+		return AV_CEIL_RSHIFT(m_frame->height, desc->log2_chroma_h);
+	}
+	return m_frame->height;
+}
+
+int AVFrameVideoBuffer::totalBytes() const
+{
+	int planes = FFMIN(av_pix_fmt_count_planes((AVPixelFormat)m_frame->format), 4);
+	int total = 0;
+	for (int i = 0; i < planes; ++i)
+	{
+		total += m_frame->linesize[i] * planeHeight(i);
+	}
+	return total;
+}
+
+QVideoFrame::PixelFormat AVFrameVideoBuffer::toQtPixelFormat(int avFormat)
+{
+	for (auto& it : PIXEL_FORMAT_MAP)
+	{
+		if (it.avFormat == avFormat)
+		{
+			return it.qtFormat;
+		}
+	}
+	return QVideoFrame::Format_Invalid;
+}
+
+int AVFrameVideoBuffer::toAVPixelFormat(QVideoFrame::PixelFormat qtFormat)
+{
+	for (auto& it : PIXEL_FORMAT_MAP)
+	{
+		if (it.qtFormat == qtFormat)
+		{
+			return it.avFormat;
+		}
+	}
+	return AV_PIX_FMT_NONE;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QAbstractVideoBuffer>
+#include <QVideoFrame>
+
+extern "C"
+{
+#include "libavutil/frame.h"
+#include "libavutil/pixdesc.h"
+}
+
+// ֱӳAVFrameƽƵbufferframeã
+class AVFrameVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+	AVFrameVideoBuffer(const AVFrame* frame);
+	~AVFrameVideoBuffer();
+
+	virtual MapMode mapMode() const;
+	virtual uchar* map(MapMode mode, int* numBytes, int* bytesPerLine);
+	virtual int mapPlanes(MapMode mode, int* numBytes, int bytesPerLine[4], uchar* data[4]);
+	virtual void unmap();
+
+	// AVPixelFormatQVideoFrame::PixelFormatӳ䣬޶ӦʱFormat_Invalid/AV_PIX_FMT_NONE
+	static QVideoFrame::PixelFormat toQtPixelFormat(int avFormat);
+	static int toAVPixelFormat(QVideoFrame::PixelFormat qtFormat);
+
+private:
+	int planeHeight(int plane) const; // ɫƽ水ʽ²
+	int totalBytes() const;
+
+	AVFrame* m_frame = nullptr;
+	MapMode m_mapMode = NotMapped;
+};
@@ -0,0 +1,191 @@
+#include "AbrController.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+
+bool AbrController::init(AVFormatContext* fmtCtx)
+{
+	m_variants.clear();
+	m_current = -1;
+	for (unsigned int i = 0; i < fmtCtx->nb_programs; ++i)
+	{
+		AVProgram* program = fmtCtx->programs[i];
+		AVDictionaryEntry* bitrate = av_dict_get(program->metadata, "variant_bitrate", nullptr, 0);
+		Variant variant;
+		variant.bandwidth = bitrate ? atoll(bitrate->value) : 0;
+		variant.programIndex = i;
+		for (unsigned int j = 0; j < program->nb_stream_indexes; ++j)
+		{
+			int inx = program->stream_index[j];
+			AVCodecParameters* par = fmtCtx->streams[inx]->codecpar;
+			if (par->codec_type == AVMEDIA_TYPE_VIDEO && variant.videoIndex < 0)
+			{
+				variant.videoIndex = inx;
+				variant.width = par->width;
+				variant.height = par->height;
+			}
+			else if (par->codec_type == AVMEDIA_TYPE_AUDIO && variant.audioIndex < 0)
+			{
+				variant.audioIndex = inx;
+			}
+		}
+		if (variant.videoIndex >= 0 && variant.bandwidth > 0)
+		{
+			m_variants.push_back(variant);
+		}
+	}
+	std::sort(m_variants.begin(), m_variants.end(), [](const Variant& a, const Variant& b) {
+		return a.bandwidth < b.bandwidth;
+	});
+	if (m_variants.size() < 2)
+	{
+		m_variants.clear();
+		return false;
+	}
+	for (const Variant& variant : m_variants)
+	{
+		std::cout << "[abr]: variant " << variant.bandwidth / 1000 << " kbps " << variant.width << "x" << variant.height
+			<< " video " << variant.videoIndex << " audio " << variant.audioIndex << std::endl;
+	}
+	return true;
+}
+
+void AbrController::reset()
+{
+	m_variants.clear();
+	m_openSegments.clear();
+	m_current = -1;
+	m_lastSwitchTime = 0;
+	m_fastEstimate = 0;
+	m_slowEstimate = 0;
+	m_totalWeight = 0;
+	m_sampleCount = 0;
+	m_bandwidth = 0;
+	m_upSwitches = 0;
+	m_downSwitches = 0;
+	m_weightedBitrate = 0;
+	m_mediaTime = 0;
+	m_averageBitrate = 0;
+}
+
+void AbrController::segmentOpened(void* key, int64_t busyClock)
+{
+	m_openSegments.push_back({ key, busyClock });
+}
+
+void AbrController::segmentClosed(void* key, int64_t bytes, int64_t busyClock)
+{
+	auto it = std::find_if(m_openSegments.begin(), m_openSegments.end(), [key](const Segment& segment) {
+		return segment.key == key;
+	});
+	if (it == m_openSegments.end())
+	{
+		return;
+	}
+	int64_t busy = busyClock - it->busyClock;
+	m_openSegments.erase(it);
+	if (bytes < MIN_SAMPLE_BYTES || busy <= 0)
+	{
+		return;
+	}
+	double weight = (double)busy / AV_TIME_BASE;
+	double sample = bytes * 8.0 / weight;
+	double fastAlpha = pow(0.5, weight / FAST_HALF_LIFE);
+	double slowAlpha = pow(0.5, weight / SLOW_HALF_LIFE);
+	m_fastEstimate = fastAlpha * m_fastEstimate + (1 - fastAlpha) * sample;
+	m_slowEstimate = slowAlpha * m_slowEstimate + (1 - slowAlpha) * sample;
+	m_totalWeight += weight;
+	m_sampleCount++;
+	m_bandwidth = estimate();
+}
+
+int64_t AbrController::estimate() const
+{
+	if (m_sampleCount < MIN_SAMPLES)
+	{
+		return 0;
+	}
+	// ʼֵΪ0ۻȨƫ
+	double fast = m_fastEstimate / (1 - pow(0.5, m_totalWeight / FAST_HALF_LIFE));
+	double slow = m_slowEstimate / (1 - pow(0.5, m_totalWeight / SLOW_HALF_LIFE));
+	return (int64_t)std::min(fast, slow);
+}
+
+int AbrController::select(int64_t bufferLevel, int64_t now)
+{
+	int64_t bandwidth = estimate();
+	if (!isEnabled() || bandwidth <= 0)
+	{
+		return m_current;
+	}
+	int target = 0;
+	for (int i = 0; i < (int)m_variants.size(); ++i)
+	{
+		if (m_variants[i].bandwidth <= bandwidth * SAFETY_FACTOR)
+		{
+			target = i;
+		}
+	}
+	if (m_current < 0)
+	{
+		return target;
+	}
+	// Ҫ㹻ĻŹлϴл㹻ãл
+	if (target > m_current && (bufferLevel < UP_BUFFER || now - m_lastSwitchTime < MIN_SWITCH_INTERVAL))
+	{
+		return m_current;
+	}
+	// ʱݲʣݵĴɻ
+	if (target < m_current && bufferLevel > DOWN_HOLD_BUFFER)
+	{
+		return m_current;
+	}
+	return target;
+}
+
+void AbrController::setCurrent(int inx, int64_t now)
+{
+	if (m_current >= 0 && inx != m_current)
+	{
+		(inx > m_current ? m_upSwitches : m_downSwitches)++;
+	}
+	m_current = inx;
+	m_lastSwitchTime = now;
+}
+
+void AbrController::applyDiscard(AVFormatContext* fmtCtx, int keep, int extra) const
+{
+	for (unsigned int i = 0; i < fmtCtx->nb_programs; ++i)
+	{
+		fmtCtx->programs[i]->discard = AVDISCARD_ALL;
+	}
+	for (unsigned int i = 0; i < fmtCtx->nb_streams; ++i)
+	{
+		fmtCtx->streams[i]->discard = AVDISCARD_ALL;
+	}
+	for (int inx : { keep, extra })
+	{
+		if (inx < 0)
+		{
+			continue;
+		}
+		AVProgram* program = fmtCtx->programs[m_variants[inx].programIndex];
+		program->discard = AVDISCARD_DEFAULT;
+		for (unsigned int j = 0; j < program->nb_stream_indexes; ++j)
+		{
+			fmtCtx->streams[program->stream_index[j]]->discard = AVDISCARD_DEFAULT;
+		}
+	}
+}
+
+void AbrController::addMedia(int64_t duration)
+{
+	if (m_current >= 0 && duration > 0)
+	{
+		m_weightedBitrate += (double)m_variants[m_current].bandwidth * duration;
+		m_mediaTime += duration;
+		m_averageBitrate = (int64_t)(m_weightedBitrate / m_mediaTime);
+	}
+}
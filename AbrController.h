@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+#include "libavutil/avutil.h"
+}
+
+// HLSӦľߺͳƣvariantбƬơʱѡ
+// discardͽлDecoderڶȡ̺߳ͽ߳
+// ͳƵgetterֻڴͶȡ߳з
+class AbrController
+{
+public:
+	struct Variant
+	{
+		int64_t bandwidth = 0; // бbps
+		int programIndex = -1;
+		int videoIndex = -1;
+		int audioIndex = -1; // ûеƵʱΪ-1
+		int width = 0;
+		int height = 0;
+	};
+
+	// ռƵvariantʱã̽ڼ
+	bool init(AVFormatContext* fmtCtx);
+	void reset(); // رʱͳ
+	bool isEnabled() const
+	{
+		return m_variants.size() > 1;
+	}
+	int variantCount() const
+	{
+		return (int)m_variants.size();
+	}
+	const Variant& variant(int inx) const
+	{
+		return m_variants[inx];
+	}
+	int current() const
+	{
+		return m_current;
+	}
+	int highest() const
+	{
+		return (int)m_variants.size() - 1;
+	}
+
+	// ƬӵĴ򿪺͹رգbusyClockǶȡʵI/Oϵۼʱ(΢)
+	// ȡ̱߳ʱ䲻룬Ƶٶ
+	void segmentOpened(void* key, int64_t busyClock);
+	void segmentClosed(void* key, int64_t bytes, int64_t busyClock);
+	int64_t estimate() const; // bpsʱΪ0
+	int64_t bandwidth() const // һιƣ̶߳ȡ
+	{
+		return m_bandwidth;
+	}
+
+	int select(int64_t bufferLevel, int64_t now); // ӦʹõvariantҪлʱcurrent()
+	void setCurrent(int inx, int64_t now);
+	// ֻkeepextra(-1ʾ)variantprogramȫdiscardhlsǵķƬ
+	void applyDiscard(AVFormatContext* fmtCtx, int keep, int extra) const;
+	void addMedia(int64_t duration); // ǰvariantýʱͳƽ
+
+	int64_t switches() const
+	{
+		return m_upSwitches + m_downSwitches;
+	}
+	int64_t upSwitches() const
+	{
+		return m_upSwitches;
+	}
+	int64_t downSwitches() const
+	{
+		return m_downSwitches;
+	}
+	int64_t averageBitrate() const // ýʱȨ
+	{
+		return m_averageBitrate;
+	}
+
+private:
+	struct Segment
+	{
+		void* key;
+		int64_t busyClock;
+	};
+
+	std::vector<Variant> m_variants;
+	std::vector<Segment> m_openSegments;
+	std::atomic<int> m_current{ -1 };
+	int64_t m_lastSwitchTime = 0;
+
+	// ƫEWMAʱȨȡСֵ
+	double m_fastEstimate = 0;
+	double m_slowEstimate = 0;
+	double m_totalWeight = 0;
+	int m_sampleCount = 0;
+	std::atomic<int64_t> m_bandwidth{ 0 };
+
+	std::atomic<int64_t> m_upSwitches{ 0 };
+	std::atomic<int64_t> m_downSwitches{ 0 };
+	double m_weightedBitrate = 0;
+	double m_mediaTime = 0;
+	std::atomic<int64_t> m_averageBitrate{ 0 };
+
+	const double FAST_HALF_LIFE = 2.0; // 
+	const double SLOW_HALF_LIFE = 5.0;
+	const int64_t MIN_SAMPLE_BYTES = 16 * 1024; // ԿinitƬ̫Сⲻ׼
+	const int MIN_SAMPLES = 2;
+	const double SAFETY_FACTOR = 0.8; // 
+	const int64_t UP_BUFFER = 5 * AV_TIME_BASE; // 岻ڴ˲
+	const int64_t DOWN_HOLD_BUFFER = 8 * AV_TIME_BASE; // ڴʱݲ
+	const int64_t MIN_SWITCH_INTERVAL = 4 * AV_TIME_BASE; // ʵС
+};
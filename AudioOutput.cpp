@@ -13,8 +13,19 @@ void AudioOutput::setSource(Decoder* source)
 
 void AudioOutput::onDataReady()
 {
+	// ´ʱʽܱ仯ͣɵٰ¸ʽ
+	if (m_audioOutput)
+	{
+		m_audioOutput->stop();
+		delete m_audioOutput;
+		m_audioOutput = nullptr;
+	}
 	m_audioFormat = m_pSourceObj->getAudioFormat();
 	m_audioOutput = new QAudioOutput(*m_audioFormat, this);
-	m_pSourceObj->open(QIODevice::ReadOnly);
+	m_pSourceObj->setAudioOutput(m_audioOutput);
+	if (!m_pSourceObj->isOpen())
+	{
+		m_pSourceObj->open(QIODevice::ReadOnly);
+	}
 	m_audioOutput->start(m_pSourceObj);
 }
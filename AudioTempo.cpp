@@ -0,0 +1,159 @@
+#include "AudioTempo.h"
+
+#include <iostream>
+#include <string>
+
+AudioTempo::AudioTempo()
+{
+	m_inFrame = av_frame_alloc();
+	m_outFrame = av_frame_alloc();
+}
+
+AudioTempo::~AudioTempo()
+{
+	close();
+	av_frame_free(&m_inFrame);
+	av_frame_free(&m_outFrame);
+}
+
+bool AudioTempo::init(double speed, int sampleRate, AVSampleFormat sampleFmt, int channels)
+{
+	close();
+
+	// 0.25 -> atempo=0.5,atempo=0.5
+	std::string chain;
+	double remain = speed;
+	while (remain < 0.5)
+	{
+		chain += "atempo=0.5,";
+		remain /= 0.5;
+	}
+	while (remain > 2.0)
+	{
+		chain += "atempo=2.0,";
+		remain /= 2.0;
+	}
+	chain += "atempo=" + std::to_string(remain);
+
+	char srcArgs[256] = { 0 };
+	snprintf(srcArgs, sizeof(srcArgs), "time_base=1/%d:sample_rate=%d:sample_fmt=%s:channel_layout=0x%llx",
+		sampleRate, sampleRate, av_get_sample_fmt_name(sampleFmt),
+		(unsigned long long)av_get_default_channel_layout(channels));
+
+	AVFilterInOut* outputs = avfilter_inout_alloc();
+	AVFilterInOut* inputs = avfilter_inout_alloc();
+	m_graph = avfilter_graph_alloc();
+	int ret = 0;
+	do
+	{
+		ret = avfilter_graph_create_filter(&m_srcCtx, avfilter_get_by_name("abuffer"), "in", srcArgs, nullptr, m_graph);
+		if (ret < 0)
+		{
+			break;
+		}
+		ret = avfilter_graph_create_filter(&m_sinkCtx, avfilter_get_by_name("abuffersink"), "out", nullptr, nullptr, m_graph);
+		if (ret < 0)
+		{
+			break;
+		}
+		outputs->name = av_strdup("in");
+		outputs->filter_ctx = m_srcCtx;
+		inputs->name = av_strdup("out");
+		inputs->filter_ctx = m_sinkCtx;
+		ret = avfilter_graph_parse_ptr(m_graph, chain.c_str(), &inputs, &outputs, nullptr);
+		if (ret < 0)
+		{
+			break;
+		}
+		ret = avfilter_graph_config(m_graph, nullptr);
+	} while (0);
+	avfilter_inout_free(&inputs);
+	avfilter_inout_free(&outputs);
+	if (ret < 0)
+	{
+		char buffer[1024] = { 0 };
+		av_strerror(ret, buffer, sizeof(buffer));
+		std::cout << "[function]:AudioTempo::init [reason]:" << buffer << std::endl;
+		close();
+		return false;
+	}
+
+	m_speed = speed;
+	m_sampleRate = sampleRate;
+	m_sampleFmt = sampleFmt;
+	m_channels = channels;
+	m_startPts = AV_NOPTS_VALUE;
+	m_bFlushed = false;
+	return true;
+}
+
+void AudioTempo::close()
+{
+	avfilter_graph_free(&m_graph);
+	m_srcCtx = nullptr;
+	m_sinkCtx = nullptr;
+	av_frame_unref(m_outFrame);
+	m_bFlushed = false;
+}
+
+bool AudioTempo::send(const uint8_t* data, int nbSamples, int64_t pts)
+{
+	if (!m_graph || m_bFlushed || nbSamples <= 0)
+	{
+		return false;
+	}
+	int64_t samplePts = pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE : av_rescale(pts, m_sampleRate, AV_TIME_BASE);
+	if (m_startPts == AV_NOPTS_VALUE)
+	{
+		m_startPts = samplePts == AV_NOPTS_VALUE ? 0 : samplePts;
+	}
+	// buffersrc´ݣm_inFrameֻõߵbuffer
+	m_inFrame->data[0] = (uint8_t*)data;
+	m_inFrame->linesize[0] = nbSamples * m_channels * av_get_bytes_per_sample(m_sampleFmt);
+	m_inFrame->extended_data = m_inFrame->data;
+	m_inFrame->nb_samples = nbSamples;
+	m_inFrame->format = m_sampleFmt;
+	m_inFrame->sample_rate = m_sampleRate;
+	m_inFrame->channels = m_channels;
+	m_inFrame->channel_layout = av_get_default_channel_layout(m_channels);
+	m_inFrame->pts = samplePts;
+	int ret = av_buffersrc_write_frame(m_srcCtx, m_inFrame);
+	m_inFrame->data[0] = nullptr;
+	m_inFrame->extended_data = nullptr;
+	return ret >= 0;
+}
+
+void AudioTempo::flush()
+{
+	if (!m_graph || m_bFlushed)
+	{
+		return;
+	}
+	av_buffersrc_add_frame(m_srcCtx, nullptr);
+	m_bFlushed = true;
+}
+
+AVFrame* AudioTempo::peek(int64_t* pts)
+{
+	if (!m_graph)
+	{
+		return nullptr;
+	}
+	if (!m_outFrame->buf[0])
+	{
+		if (av_buffersink_get_frame(m_sinkCtx, m_outFrame) < 0)
+		{
+			return nullptr;
+		}
+		// ʱϾĲٶȼýʱϵ
+		m_outPts = m_outFrame->pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE :
+			av_rescale(m_startPts + (int64_t)((m_outFrame->pts - m_startPts) * m_speed), AV_TIME_BASE, m_sampleRate);
+	}
+	*pts = m_outPts;
+	return m_outFrame;
+}
+
+void AudioTempo::pop()
+{
+	av_frame_unref(m_outFrame);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+extern "C"
+{
+#include "libavutil/avutil.h"
+#include "libavutil/channel_layout.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersrc.h"
+#include "libavfilter/buffersink.h"
+}
+
+// ٲزĽ֯PCMatempo˾
+// atempoȡ[0.5, 2]֮ãʱ
+class AudioTempo
+{
+public:
+	AudioTempo();
+	~AudioTempo();
+
+	// ½˾֮ǰ˾δݶҪʱflushȡ
+	bool init(double speed, int sampleRate, AVSampleFormat sampleFmt, int channels);
+	void close();
+	bool isActive() const
+	{
+		return m_graph != nullptr;
+	}
+	double speed() const
+	{
+		return m_graph ? m_speed : 1.0;
+	}
+
+	// ptsΪýʱϵAV_TIME_BASE
+	bool send(const uint8_t* data, int nbSamples, int64_t pts);
+	// ǣ˾лȡ֮send
+	void flush();
+	// 鿴һ֡ûʱnullptrȡߣŲʱ´ȡͬһ֡
+	// ptsýʱߣƵʱ
+	AVFrame* peek(int64_t* pts);
+	void pop(); // ȡpeekص֡
+
+private:
+	AVFilterGraph* m_graph = nullptr;
+	AVFilterContext* m_srcCtx = nullptr;
+	AVFilterContext* m_sinkCtx = nullptr;
+	AVFrame* m_inFrame = nullptr;
+	AVFrame* m_outFrame = nullptr; // peekȡδpop֡
+	int64_t m_outPts = AV_NOPTS_VALUE;
+	bool m_bFlushed = false;
+	double m_speed = 1.0;
+	int m_sampleRate = 0;
+	AVSampleFormat m_sampleFmt = AV_SAMPLE_FMT_NONE;
+	int m_channels = 0;
+	int64_t m_startPts = AV_NOPTS_VALUE; // atempoptsӵһ֡뿪ʼۼ
+};
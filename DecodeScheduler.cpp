@@ -0,0 +1,222 @@
+#include "DecodeScheduler.h"
+
+#include <algorithm>
+
+struct DecodeScheduler::Task
+{
+	TaskFunc func;
+	Priority prio;
+	bool bDone = false; // m_mutex
+	// ԣbParkedٲbWakePendingѷbWakePendingٲbParkedᶼ
+	std::atomic<bool> bParked{ false };
+	std::atomic<bool> bWakePending{ false };
+};
+
+DecodeScheduler* DecodeScheduler::instance()
+{
+	static DecodeScheduler scheduler(SDL_GetCPUCount());
+	return &scheduler;
+}
+
+DecodeScheduler::DecodeScheduler(int workerNum)
+{
+	m_mutex = SDL_CreateMutex();
+	m_workCond = SDL_CreateCond();
+	m_doneCond = SDL_CreateCond();
+	workerNum = std::max(workerNum, 1);
+	for (int i = 0; i < workerNum; ++i)
+	{
+		Worker* worker = new Worker;
+		worker->mutex = SDL_CreateMutex();
+		worker->owner = this;
+		worker->inx = i;
+		m_workers.push_back(worker);
+	}
+	// ȫúȡʱworker
+	for (Worker* worker : m_workers)
+	{
+		worker->thread = SDL_CreateThread(workerThread, "decodeWorker", worker);
+	}
+}
+
+DecodeScheduler::~DecodeScheduler()
+{
+	SDL_LockMutex(m_mutex);
+	m_bQuit = true;
+	SDL_CondBroadcast(m_workCond);
+	SDL_UnlockMutex(m_mutex);
+	// ȫ˳ͷţworker˳ǰԿȡ
+	for (Worker* worker : m_workers)
+	{
+		SDL_WaitThread(worker->thread, NULL);
+	}
+	for (Worker* worker : m_workers)
+	{
+		SDL_DestroyMutex(worker->mutex);
+		delete worker;
+	}
+	SDL_DestroyCond(m_doneCond);
+	SDL_DestroyCond(m_workCond);
+	SDL_DestroyMutex(m_mutex);
+}
+
+DecodeScheduler::Task* DecodeScheduler::submit(TaskFunc func, Priority prio)
+{
+	Task* task = new Task;
+	task->func = std::move(func);
+	task->prio = prio;
+	pushTask(m_workers[m_nextWorker++ % m_workers.size()], task);
+	return task;
+}
+
+void DecodeScheduler::wait(Task* task)
+{
+	// еŻضУabort
+	wake(task);
+	SDL_LockMutex(m_mutex);
+	while (!task->bDone)
+	{
+		SDL_CondWait(m_doneCond, m_mutex);
+	}
+	SDL_UnlockMutex(m_mutex);
+	delete task;
+}
+
+void DecodeScheduler::wake(Task* task)
+{
+	task->bWakePending.store(true);
+	if (!task->bParked.load())
+	{
+		return;
+	}
+	SDL_LockMutex(m_mutex);
+	bool bWoken = unpark(task);
+	SDL_UnlockMutex(m_mutex);
+	if (bWoken)
+	{
+		pushTask(m_workers[m_nextWorker++ % m_workers.size()], task);
+	}
+}
+
+void DecodeScheduler::park(Task* task)
+{
+	SDL_LockMutex(m_mutex);
+	task->bParked.store(true);
+	m_parked.push_back(task);
+	// ִڼѱѣ
+	bool bWoken = task->bWakePending.load() && unpark(task);
+	SDL_UnlockMutex(m_mutex);
+	if (bWoken)
+	{
+		pushTask(m_workers[m_nextWorker++ % m_workers.size()], task);
+	}
+}
+
+bool DecodeScheduler::unpark(Task* task)
+{
+	if (!task->bParked.load())
+	{
+		return false;
+	}
+	task->bParked.store(false);
+	m_parked.erase(std::find(m_parked.begin(), m_parked.end(), task));
+	return true;
+}
+
+void DecodeScheduler::pushTask(Worker* worker, Task* task)
+{
+	SDL_LockMutex(worker->mutex);
+	worker->tasks[(int)task->prio].push_back(task);
+	SDL_UnlockMutex(worker->mutex);
+	m_readyCount++;
+	// workerThreadȼm_sleepersٲm_readyCountԣ©
+	if (m_sleepers.load() > 0)
+	{
+		SDL_LockMutex(m_mutex);
+		SDL_CondSignal(m_workCond);
+		SDL_UnlockMutex(m_mutex);
+	}
+}
+
+DecodeScheduler::Task* DecodeScheduler::takeTask(Worker* self)
+{
+	for (int prio = 0; prio < (int)Priority::COUNT; ++prio)
+	{
+		Task* task = nullptr;
+		SDL_LockMutex(self->mutex);
+		std::deque<Task*>& own = self->tasks[prio];
+		if (!own.empty())
+		{
+			task = own.front();
+			own.pop_front();
+		}
+		SDL_UnlockMutex(self->mutex);
+		// һworkerʼȡⶼȥͬһ
+		for (size_t i = 1; !task && i < m_workers.size(); ++i)
+		{
+			Worker* victim = m_workers[(self->inx + i) % m_workers.size()];
+			SDL_LockMutex(victim->mutex);
+			std::deque<Task*>& other = victim->tasks[prio];
+			if (!other.empty())
+			{
+				task = other.back();
+				other.pop_back();
+				m_steals++;
+			}
+			SDL_UnlockMutex(victim->mutex);
+		}
+		if (task)
+		{
+			m_readyCount--;
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+int DecodeScheduler::workerThread(void* data)
+{
+	Worker* self = static_cast<Worker*>(data);
+	DecodeScheduler* obj = self->owner;
+	while (1)
+	{
+		Task* task = obj->takeTask(self);
+		if (!task)
+		{
+			SDL_LockMutex(obj->m_mutex);
+			if (obj->m_bQuit)
+			{
+				SDL_UnlockMutex(obj->m_mutex);
+				break;
+			}
+			obj->m_sleepers++;
+			if (obj->m_readyCount.load() == 0)
+			{
+				SDL_CondWaitTimeout(obj->m_workCond, obj->m_mutex, obj->SLEEP_WAIT_MS);
+			}
+			obj->m_sleepers--;
+			SDL_UnlockMutex(obj->m_mutex);
+			continue;
+		}
+
+		// ֮Ļpark飬֮ǰɱִд
+		task->bWakePending.store(false);
+		TaskState state = task->func();
+		if (state == TaskState::BUSY)
+		{
+			obj->pushTask(self, task);
+		}
+		else if (state == TaskState::IDLE)
+		{
+			obj->park(task);
+		}
+		else
+		{
+			SDL_LockMutex(obj->m_mutex);
+			task->bDone = true;
+			SDL_CondBroadcast(obj->m_doneCond);
+			SDL_UnlockMutex(obj->m_mutex);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <functional>
+#include <atomic>
+
+extern "C"
+{
+#include "SDL2/SDL.h"
+}
+
+// ڹĽDecoderù̶Ĺ߳
+// ÿ߳ԼУʱ̵߳Ķβȡ
+// ÿִֻвһIDLEʱֱȴĶл״̬仯ʱwake
+class DecodeScheduler
+{
+public:
+	enum class TaskState
+	{
+		BUSY = 0, // нչ
+		IDLE, // ȴ롢ռseek/رգwake
+		DONE, // ٵ
+	};
+	enum class Priority
+	{
+		HIGH = 0, // Ƶִͨкȡ
+		NORMAL,
+		COUNT,
+	};
+	typedef std::function<TaskState()> TaskFunc;
+	struct Task;
+
+	static DecodeScheduler* instance(); // ״εʱ߳ΪCPU
+
+	Task* submit(TaskFunc func, Priority prio);
+	void wait(Task* task); // 񷵻DONE֮taskʧЧ
+	// ȴʱạִ̃߳е񷵻IDLEµ
+	void wake(Task* task);
+
+	int workerCount() const
+	{
+		return (int)m_workers.size();
+	}
+	unsigned long long steals() const
+	{
+		return m_steals.load();
+	}
+
+private:
+	struct Worker
+	{
+		std::deque<Task*> tasks[(int)Priority::COUNT];
+		SDL_mutex* mutex = nullptr;
+		SDL_Thread* thread = nullptr;
+		DecodeScheduler* owner = nullptr;
+		size_t inx = 0;
+	};
+
+	DecodeScheduler(int workerNum);
+	~DecodeScheduler();
+
+	static int workerThread(void* data);
+	void pushTask(Worker* worker, Task* task);
+	Task* takeTask(Worker* self); // ȡԼĶףȡ̵߳Ķβȼͨ
+	void park(Task* task);
+	bool unpark(Task* task); // ʱm_mutexfalseʾδ
+
+	std::vector<Worker*> m_workers;
+	std::atomic<unsigned int> m_nextWorker{ 0 }; // submitͻ
+	std::vector<Task*> m_parked; // 
+	std::atomic<int> m_readyCount{ 0 }; // дִе
+	std::atomic<int> m_sleepers{ 0 }; // ȴm_workCondĹ߳
+	SDL_mutex* m_mutex = nullptr; // m_parkedɱ
+	SDL_cond* m_workCond = nullptr; // 
+	SDL_cond* m_doneCond = nullptr; // 
+	bool m_bQuit = false;
+
+	std::atomic<unsigned long long> m_steals{ 0 };
+
+	const Uint32 SLEEP_WAIT_MS = 100; // ûκʱĵȴʱ
+};
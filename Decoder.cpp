@@ -1,4 +1,5 @@
 #include "Decoder.h"
+#include <QStandardPaths>
 
 #include <iostream>
 
@@ -16,8 +17,22 @@ FILE* g_pcmFp;
 /* no AV correction is done if too big error */
 #define AV_NOSYNC_THRESHOLD 10.0
 
+// Դʽsurface֧ʱ˳ѡתĿ
+static const QVideoFrame::PixelFormat PREFERRED_PIXEL_FORMATS[] = {
+	QVideoFrame::Format_YUV420P,
+	QVideoFrame::Format_NV12,
+	QVideoFrame::Format_YUV422P,
+	QVideoFrame::Format_RGB32,
+};
+
+// frameSkipLevel
+static const AVDiscard SKIP_LOOP_FILTER_LEVELS[] = { AVDISCARD_DEFAULT, AVDISCARD_ALL, AVDISCARD_ALL, AVDISCARD_ALL };
+static const AVDiscard SKIP_FRAME_LEVELS[] = { AVDISCARD_DEFAULT, AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_NONKEY };
+
 Decoder::Decoder(std::string&& fullPath, QObject* parents) : QIODevice(parents)
 {
+	connectTaskWake();
+	startStatsTimer();
 	m_filePath = fullPath;
 	m_bInitSuccessful = openStream(std::forward<std::string&&>(fullPath));
 	eventLoop(this);
@@ -25,11 +40,65 @@ Decoder::Decoder(std::string&& fullPath, QObject* parents) : QIODevice(parents)
 
 Decoder::Decoder(QObject* parents) : QIODevice(parents)
 {
+	connectTaskWake();
+	startStatsTimer();
 }
 
 Decoder::~Decoder()
 {
 	closeStream();
+	SDL_DestroyMutex(m_playlistMutex);
+	SDL_DestroySemaphore(m_prerollDone);
+	SDL_DestroyMutex(m_taskMutex);
+}
+
+void Decoder::startStatsTimer()
+{
+	m_statsTimer.setInterval(STATS_NOTIFY_MS);
+	connect(&m_statsTimer, &QTimer::timeout, this, &Decoder::statsChanged);
+	m_statsTimer.start();
+}
+
+void Decoder::connectTaskWake()
+{
+	// аѽпλѶȡ񣻽пռ份ѽ
+	m_audioPktQue.notEmpty.listener = [this] { wakeTask(m_audioDecTask); };
+	m_videoPktQue.notEmpty.listener = [this] { wakeTask(m_videoDecTask); };
+	m_audioPktQue.notFull.listener = [this] { wakeTask(m_readTask); };
+	m_videoPktQue.notFull.listener = [this] { wakeTask(m_readTask); };
+	m_audioRing.notFull.listener = [this] { wakeTask(m_audioDecTask); };
+	m_videoFrameQue.listener = [this] { wakeTask(m_videoDecTask); };
+	// seek͹رգҲ
+	m_playControl.stateEvent.listener = [this] {
+		wakeTask(m_readTask);
+		wakeTask(m_audioDecTask);
+		wakeTask(m_videoDecTask);
+	};
+}
+
+void Decoder::wakeTask(std::atomic<DecodeScheduler::Task*>& task)
+{
+	if (!task.load())
+	{
+		return; // ߳ģʽ
+	}
+	SDL_LockMutex(m_taskMutex);
+	if (task.load())
+	{
+		DecodeScheduler::instance()->wake(task.load());
+	}
+	SDL_UnlockMutex(m_taskMutex);
+}
+
+void Decoder::waitTask(std::atomic<DecodeScheduler::Task*>& task)
+{
+	SDL_LockMutex(m_taskMutex);
+	DecodeScheduler::Task* t = task.exchange(nullptr);
+	SDL_UnlockMutex(m_taskMutex);
+	if (t)
+	{
+		DecodeScheduler::instance()->wait(t);
+	}
 }
 
 void Decoder::setVideoUrl(QString videoUrl)
@@ -39,10 +108,20 @@ void Decoder::setVideoUrl(QString videoUrl)
 		m_filePath = videoUrl.toStdString();
 		m_videoUrl = videoUrl;
 		emit videoUrlChanged();
-		if (m_videoSurface)
-		{
-			m_bInitSuccessful = openStream(m_videoUrl.toStdString());
-		}
+		reopenStream();
+	}
+}
+
+void Decoder::reopenStream()
+{
+	// ɵĶȡ¼߳˳ٴ
+	if (m_fmtCtx)
+	{
+		closeStream();
+	}
+	if (m_videoSurface && !m_filePath.empty())
+	{
+		m_bInitSuccessful = openStream(m_filePath);
 	}
 }
 
@@ -62,7 +141,7 @@ void Decoder::setVideoSurface(QAbstractVideoSurface* surface)
 
 	if (!m_videoUrl.isEmpty())
 	{
-		m_bInitSuccessful = openStream(m_videoUrl.toStdString());
+		reopenStream();
 	}
 }
 
@@ -82,557 +161,2457 @@ void Decoder::setFormat(int width, int heigth, QVideoFrame::PixelFormat pixForma
 	}
 }
 
-void Decoder::onNewVideoFrameReceived(const QVideoFrame& frame)
+void Decoder::setDecodeThreadMode(DecodeThreadMode mode)
 {
-	if (m_videoSurface)
-		m_videoSurface->present(frame);
+	if (m_decodeThreadMode != mode)
+	{
+		m_decodeThreadMode = mode;
+		emit decodeThreadModeChanged();
+	}
 }
 
-void Decoder::openVideoStream()
+void Decoder::setDecodeThreadCount(int count)
 {
-	AVCodec* pVideoCdec = avcodec_find_decoder(m_pVideoCodecParam->codec_id);
-	if (pVideoCdec)
+	count = FFMAX(count, 0);
+	if (m_decodeThreadCount != count)
 	{
-		m_videoCodecCtx = avcodec_alloc_context3(pVideoCdec);
-		avcodec_parameters_to_context(m_videoCodecCtx, m_pVideoCodecParam);
-		avcodec_open2(m_videoCodecCtx, pVideoCdec, nullptr);
-		m_swsCtx = sws_getContext(m_pVideoCodecParam->width,
-			m_pVideoCodecParam->height,
-			(AVPixelFormat)m_pVideoCodecParam->format,
-			m_pVideoCodecParam->width,
-			m_pVideoCodecParam->height,
-			(AVPixelFormat)preset[0], 0, nullptr, nullptr, nullptr);
-
-		m_pVideoFrame = av_frame_alloc();
-		m_pVideoOutFrame = av_frame_alloc();
-		m_videoOutBufferSize = av_image_get_buffer_size((AVPixelFormat)preset[0], m_pVideoCodecParam->width, m_pVideoCodecParam->height, 1);
-		m_pVideoOutBuffer = av_mallocz(m_videoOutBufferSize);
-		av_image_fill_arrays(m_pVideoOutFrame->data,
-			m_pVideoOutFrame->linesize,
-			(const uint8_t*)m_pVideoOutBuffer,
-			(AVPixelFormat)preset[0],
-			m_pVideoCodecParam->width,
-			m_pVideoCodecParam->height, 1);
-
-		int frameSize = m_pVideoCodecParam->width * m_pVideoCodecParam->height * 3 / 2;
-		setFormat(m_pVideoCodecParam->width, m_pVideoCodecParam->height, QVideoFrame::Format_YUV420P);
-		m_frame.reset(new QVideoFrame(
-			frameSize, 
-			QSize(m_pVideoCodecParam->width, m_pVideoCodecParam->height),
-			m_pVideoCodecParam->width,
-			QVideoFrame::Format_YUV420P));
-		connect(this, &Decoder::newVideoFrame, this, &Decoder::onNewVideoFrameReceived);
-		//m_pVideowin = SDL_CreateWindow("Decoder", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, m_pVideoCodecParam->width, m_pVideoCodecParam->height, SDL_WINDOW_OPENGL);
-		//m_pRender = SDL_CreateRenderer(m_pVideowin, -1, 0);
-		//m_pTexture = SDL_CreateTexture(m_pRender, preset[1], SDL_TEXTUREACCESS_STREAMING, m_pVideoCodecParam->width, m_pVideoCodecParam->height);
-		//m_textureRect = { 0, 0, m_pVideoCodecParam->width, m_pVideoCodecParam->height };
-
-		m_videoDecThread = SDL_CreateThread(videoDecodeThread, "videoDecode", this);
+		m_decodeThreadCount = count;
+		emit decodeThreadCountChanged();
 	}
 }
 
-void Decoder::openAudioStream()
+void Decoder::setSharedScheduler(bool bShared)
 {
-	AVCodec* pAudioCdec = avcodec_find_decoder(m_pAudioCodecParam->codec_id);
-	if (pAudioCdec)
+	if (m_bSharedScheduler != bShared)
 	{
-		m_audioCodecCtx = avcodec_alloc_context3(pAudioCdec);
-		avcodec_parameters_to_context(m_audioCodecCtx, m_pAudioCodecParam);
-		m_audioCodecCtx->pkt_timebase = m_fmtCtx->streams[m_nAudioInx]->time_base;
-		avcodec_open2(m_audioCodecCtx, pAudioCdec, nullptr);
-		m_swrCtx = swr_alloc_set_opts(m_swrCtx,
-			m_pAudioCodecParam->channel_layout, (AVSampleFormat)m_audioFormatPreset[0], m_pAudioCodecParam->sample_rate,
-			m_pAudioCodecParam->channel_layout, (AVSampleFormat)m_pAudioCodecParam->format, m_pAudioCodecParam->sample_rate,
-			-1, nullptr);
-		swr_init(m_swrCtx);
-		
-		m_settingSpec.freq = m_pAudioCodecParam->sample_rate;
-		m_settingSpec.format = m_audioFormatPreset[1];
-		m_settingSpec.channels = m_pAudioCodecParam->channels;
-		m_settingSpec.samples = m_pAudioCodecParam->frame_size;
-		m_settingSpec.silence = 0;
-		m_settingSpec.callback = audioCallback;
-		m_settingSpec.userdata = this;
-
-		//SDL_AudioSpec realSpec;
-		//SDL_OpenAudio(&m_settingSpec, nullptr);
-
- 		//SDL_PauseAudio(0);
-
-		m_audioFormat.setCodec("audio/pcm");
-		m_audioFormat.setSampleRate(m_pAudioCodecParam->sample_rate);
-		m_audioFormat.setSampleSize(av_get_bytes_per_sample((AVSampleFormat)m_audioFormatPreset[0])*8);
-		m_audioFormat.setSampleType(QAudioFormat::SignedInt);
-		m_audioFormat.setChannelCount(m_pAudioCodecParam->channels);
-		m_audioFormat.setByteOrder(QAudioFormat::LittleEndian);
-
-		m_pAudioFrame = av_frame_alloc();
-		m_audioBufferTotalSize = av_samples_get_buffer_size(
-			nullptr,
-			m_settingSpec.channels,
-			m_settingSpec.freq,
-			(AVSampleFormat)m_audioFormatPreset[0],
-			1
-		);
-		m_audioBuff = (void*)new char[m_audioBufferTotalSize];
-		m_nChannelFormatByte =
-			m_settingSpec.channels * av_get_bytes_per_sample((AVSampleFormat)m_audioFormatPreset[0]);
-
-		m_audioDecThread = SDL_CreateThread(audioDecodeThread, "audioDecode", this);
+		m_bSharedScheduler = bShared;
+		emit sharedSchedulerChanged();
 	}
 }
 
-bool Decoder::openStream(std::string filePath)
+void Decoder::setKeyframeIndex(bool bIndex)
 {
-#ifdef SAVEPCM
-	g_pcmFp = fopen("C:/Users/1/Desktop/test.pcm", "wb");
-#endif
-
-	int ret = 0;
-	ret = avformat_open_input(&m_fmtCtx, filePath.c_str(), nullptr, nullptr);
-	if (ret < 0)
+	if (m_bKeyframeIndex != bIndex)
 	{
-		outputError("avformat_open_input", ret);
-		return false;
+		m_bKeyframeIndex = bIndex;
+		emit keyframeIndexChanged();
 	}
+}
 
-	ret = avformat_find_stream_info(m_fmtCtx, nullptr);
-	if (ret < 0)
+void Decoder::setMmapIO(bool bMmap)
+{
+	if (m_bMmapIO != bMmap)
 	{
-		outputError("avformat_open_input", ret);
-		return false;
+		m_bMmapIO = bMmap;
+		emit mmapIOChanged();
 	}
+}
 
-	for (int i = 0; i < m_fmtCtx->nb_streams; ++i)
+void Decoder::setReadAheadSize(int sizeMB)
+{
+	sizeMB = FFMAX(sizeMB, 0);
+	if (m_readAheadSize != sizeMB)
 	{
-		if (m_fmtCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
-		{
-			m_nAudioInx = i;
-			m_pAudioCodecParam = m_fmtCtx->streams[i]->codecpar;
-		}
-		if (m_fmtCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
-		{
-			m_nVideoInx = i;
-			m_pVideoCodecParam = m_fmtCtx->streams[i]->codecpar;
-		}
+		m_readAheadSize = sizeMB;
+		emit readAheadSizeChanged();
 	}
+}
 
-	// Ƶڵ
-	if (m_nAudioInx == -1 && m_nVideoInx == -1)
+void Decoder::setIoThrottle(int kbps)
+{
+	kbps = FFMAX(kbps, 0);
+	if (m_ioThrottle != kbps)
 	{
-		std::cout << "m_nAudioInx == -1 && m_nVideoInx == -1" << std::endl;
-		return false;
+		m_ioThrottle = kbps;
+		emit ioThrottleChanged();
 	}
+}
 
-	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER);
-	// Ƶؽṹ
-	if (m_nAudioInx >= 0)
+void Decoder::setHttpCache(bool bCache)
+{
+	if (m_bHttpCache != bCache)
 	{
-		openAudioStream();
+		m_bHttpCache = bCache;
+		emit httpCacheChanged();
 	}
-	// Ƶؽṹ
-	if (m_nVideoInx >= 0)
+}
+
+void Decoder::setHttpCacheBudget(int sizeMB)
+{
+	sizeMB = FFMAX(sizeMB, 0);
+	if (m_httpCacheBudget != sizeMB)
 	{
-		openVideoStream();
+		m_httpCacheBudget = sizeMB;
+		emit httpCacheBudgetChanged();
 	}
-
-	m_pRreadPkt = av_packet_alloc();
-	m_readThread = SDL_CreateThread(readThread, "readData", this);
-	m_eventLoopThread = SDL_CreateThread(eventLoop, "eventLoop", this);
-	
-	evalCacheMax();
-
-	emit dataReady();
-
-	return m_nAudioInx >= 0 || m_nVideoInx >= 0; // Ƶ
 }
 
-void Decoder::closeVideoStream()
+void Decoder::setAbr(bool bAbr)
 {
-	if (m_videoCodecCtx)
+	if (m_bAbr != bAbr)
 	{
-		SDL_WaitThread(m_videoDecThread, NULL);
-		sws_freeContext(m_swsCtx);
-		av_frame_free(&m_pVideoOutFrame);
-		av_frame_free(&m_pVideoFrame);
-		avcodec_free_context(&m_videoCodecCtx);
-
-		/*SDL_DestroyTexture(m_pTexture);
-		SDL_DestroyRenderer(m_pRender);
-		SDL_DestroyWindow(m_pVideowin);*/
+		m_bAbr = bAbr;
+		emit abrChanged();
 	}
 }
 
-void Decoder::closeAudioStream()
+void Decoder::setProbeCache(bool bCache)
 {
-	if (m_audioCodecCtx)
+	if (m_bProbeCache != bCache)
 	{
-		SDL_WaitThread(m_audioDecThread, NULL);
-		//SDL_CloseAudio();
-		delete m_audioBuff;
-		swr_close(m_swrCtx);
-		av_frame_free(&m_pAudioFrame);
-		avcodec_free_context(&m_audioCodecCtx);
+		m_bProbeCache = bCache;
+		emit probeCacheChanged();
 	}
 }
 
-void Decoder::closeStream()
+QStringList Decoder::playlist()
 {
-	m_playControl.bAbort = true;
-	closeAudioStream();
-	closeVideoStream();
-	SDL_WaitThread(m_readThread, NULL);
-	av_packet_free(&m_pRreadPkt);
-	avformat_close_input(&m_fmtCtx);
+	SDL_LockMutex(m_playlistMutex);
+	QStringList playlist = m_playlist;
+	SDL_UnlockMutex(m_playlistMutex);
+	return playlist;
 }
 
-void Decoder::updateAudioBuffer()
+void Decoder::setPlaylist(QStringList playlist)
 {
-	if (m_audioBufferSize > 0)
+	SDL_LockMutex(m_playlistMutex);
+	m_playlist = playlist;
+	SDL_UnlockMutex(m_playlistMutex);
+	emit playlistChanged();
+	// лбҲرյǰӵһ¿ʼ
+	if (!playlist.isEmpty())
 	{
-		return;
+		m_playlistIndex = 0;
+		emit playlistIndexChanged();
+		m_filePath = playlist.first().toStdString();
+		if (m_videoUrl != playlist.first())
+		{
+			m_videoUrl = playlist.first();
+			emit videoUrlChanged();
+		}
+		reopenStream();
 	}
+}
 
-	m_audioBufferCurInx = -1;
-	m_audioBufferSize = 0;
-	if (m_curAudioData)
+void Decoder::setPreroll(int prerollMs)
+{
+	prerollMs = FFMAX(prerollMs, 0);
+	if (m_preroll != prerollMs)
 	{
-		delete m_curAudioData;
-		m_curAudioData = nullptr;
+		m_preroll = prerollMs;
+		emit prerollChanged();
 	}
-	if (m_audioFrameQue.pop(&m_curAudioData) == QueueState::NORMAL)
+}
+
+void Decoder::setLiveMode(LiveMode mode)
+{
+	if (m_liveMode != mode)
 	{
-		m_audioBufferSize = m_curAudioData->nBufferSize;
-		m_audioBufferCurInx = 0;
-		m_audioClk = av_rescale_q(m_curAudioData->framePts, m_audioCodecCtx->time_base, {1, AV_TIME_BASE}); // ʱ
-		//m_audioClk = m_audioClk * av_q2d({ 1, AV_TIME_BASE });
+		m_liveMode = mode;
+		emit liveModeChanged();
 	}
 }
 
-bool Decoder::playAudioEof()
+void Decoder::setLiveTargetLatency(int latencyMs)
 {
-	return m_playControl.bAudioDecodeEof && m_audioFrameQue.getCurState() == QueueState::EMPTY && m_audioBufferSize == 0;
+	latencyMs = FFMAX(latencyMs, 0);
+	if (m_liveTargetLatency != latencyMs)
+	{
+		m_liveTargetLatency = latencyMs;
+		emit liveTargetLatencyChanged();
+	}
 }
 
-qint64 Decoder::readData(char* stream, qint64 len)
+void Decoder::setPaused(bool bPause)
 {
-	qint64 maxLen = len;
-	memset(stream, 0, len);
-	if (playAudioEof())
+	if (m_playControl.bPause != bPause)
 	{
-		m_playControl.bPlayAudioEof = true;
-		return 0;
+		m_playControl.bPause = bPause;
+		if (!bPause && !m_bReverse)
+		{
+			resumeForward();
+		}
+		m_playControl.stateEvent.notify();
+		emit pausedChanged();
 	}
-	while (len > 0)
+}
+
+void Decoder::setReverse(bool bReverse)
+{
+	if (m_bReverse != bReverse && m_videoCodecCtx)
 	{
-		updateAudioBuffer();
-		if (m_audioBufferSize == 0)
-			break;
-		int minSize = FFMIN(len, m_audioBufferSize);
-		memcpy(stream, (char*)(m_curAudioData->pAudioBuffer) + m_audioBufferCurInx, minSize);
-		m_audioBufferSize -= minSize;
-		m_audioBufferCurInx += minSize;
-		stream += minSize;
-		len -= minSize;
+		m_bReverse = bReverse;
+		if (!bReverse && !m_playControl.bPause)
+		{
+			resumeForward();
+		}
+		m_playControl.stateEvent.notify();
+		emit reverseChanged();
 	}
-	return maxLen;
 }
 
-void Decoder::audioCallback(void* userdata, Uint8* stream, int len)
+void Decoder::stepFrame(bool bForward)
 {
-	memset(stream, 0, len);
-	Decoder* obj = static_cast<Decoder*>(userdata);
-	if (obj->playAudioEof())
+	if (!m_videoCodecCtx)
 	{
-		obj->m_playControl.bPlayAudioEof = true;
 		return;
 	}
-	while (len > 0)
+	if (!m_playControl.bPause)
 	{
-		obj->updateAudioBuffer();
-		if (obj->m_audioBufferSize == 0)
-			break;
-		int minSize = FFMIN(len, obj->m_audioBufferSize);
-		SDL_MixAudio(stream, (Uint8*)(obj->m_curAudioData->pAudioBuffer)+obj->m_audioBufferCurInx, minSize, SDL_MIX_MAXVOLUME);
-		obj->m_audioBufferSize -= minSize;
-		obj->m_audioBufferCurInx += minSize;
-		stream += minSize;
-		len -= minSize;
+		m_playControl.bPause = true;
+		emit pausedChanged();
 	}
+	m_stepRequest += bForward ? 1 : -1;
+	m_playControl.stateEvent.notify();
 }
 
-// 黹
-void Decoder::videoSyncClock(int lastPts)
+void Decoder::resumeForward()
 {
-	double duration = m_videoClk - lastPts; // ǰ֡ĳʱ
-	double diff = m_videoClk - m_audioClk;
-	double sync_threshold = FFMAX(AV_SYNC_THRESHOLD_MIN, FFMIN(AV_SYNC_THRESHOLD_MAX, duration));
-	//std::cout << "sync_threshold=" << sync_threshold << " duration=" << duration << std::endl;
-	std::cout << duration << " " << diff << std::endl;
-	if (diff <= -sync_threshold)
-	{
-		duration = FFMAX(0, duration + diff);
-	}
-	else if (diff >= sync_threshold && duration > AV_SYNC_FRAMEDUP_THRESHOLD)
-	{
-		duration = duration + diff;
-	}
-	else if (diff >= sync_threshold)
+	// ֻGopCacheʱˮʾ֡һ£ʾ֡¿ʼ
+	if (m_videoCodecCtx && m_bReviewMoved.exchange(false))
 	{
-		duration = 2 * duration;
+		seek(FFMAX(m_videoClk - m_playlistPresentBase, 0) / 1000, SeekAccurate);
+		return;
 	}
+	resumeClocks();
+}
 
-	if (duration > 0)
+void Decoder::resumeClocks()
+{
+	// ͣڼʱ԰ʵʱƣõĻָ֡
+	m_audioClock.reset();
+	m_videoClock.reset();
+	m_externalClock.reset();
+	m_resumeSerial++;
+	// ֱͣڼѹ׷϶seek
+	if (m_bLive)
 	{
-		av_usleep(duration);
+		m_bLiveResumed = true;
 	}
 }
 
-bool Decoder::playVideoEof()
+void Decoder::setClockMode(ClockMode mode)
 {
-	return m_playControl.bVideoDecodeEof && m_videoFrameQue.getCurState() == QueueState::EMPTY;
+	if (m_clockMode != mode)
+	{
+		m_clockMode = mode;
+		emit clockModeChanged();
+	}
 }
 
-void Decoder::evalCacheMax()
+Decoder::ClockMode Decoder::activeClockMode()
 {
-	if (m_audioCodecCtx)
+	// ʱӶӦʱ˻ⲿʱ
+	if ((m_clockMode == ClockAudio && !m_audioCodecCtx) || (m_clockMode == ClockVideo && !m_videoCodecCtx))
 	{
-		int oneSecAudioByte = m_nChannelFormatByte* m_settingSpec.freq;
-		m_audioCacheMaxByte = oneSecAudioByte * PRELOADSEC;
+		return ClockExternal;
 	}
-	if (m_videoCodecCtx)
-	{
-		int fps = m_fmtCtx->streams[m_nVideoInx]->avg_frame_rate.num;
-		fps = fps <= 0? m_videoCodecCtx->framerate.num:fps;
-		fps = fps <= 0? 30:fps;
-		int oneVideoFrameByte = m_pVideoCodecParam->width* m_pVideoCodecParam->height * 3 / 2;
-		int oneSecVideoByte = oneVideoFrameByte * fps;
-		m_videoCacheMaxByte = oneSecVideoByte * PRELOADSEC;
-	}	
+	return m_clockMode;
 }
 
-void Decoder::refreshVideo()
+int64_t Decoder::masterClock(int64_t time)
 {
-	if (m_videoCodecCtx)
+	switch (activeClockMode())
 	{
-		if (playVideoEof())
-		{
-			if (m_curVideoData)
-			{
-				delete m_curVideoData;
-				m_curVideoData = nullptr;
-			}
-			m_playControl.bPlayVideoEof = true;
-			return;
-		}
-		m_lastVideoData = m_curVideoData;
-		if (m_videoFrameQue.pop(&m_curVideoData) == QueueState::NORMAL)
-		{
-			if (m_lastVideoData)
-			{
-				delete m_lastVideoData;
-				m_lastVideoData = nullptr;
-			}
-			int lastClk = m_videoClk;
-			m_videoClk = av_rescale_q(m_curVideoData->framePts, m_videoCodecCtx->time_base, { 1, AV_TIME_BASE });
-			//m_videoClk = m_videoClk * av_q2d({ 1, AV_TIME_BASE });
-			videoSyncClock(lastClk);
-			if (m_frame->map(QAbstractVideoBuffer::WriteOnly)) {
-				memcpy(m_frame->bits(), m_curVideoData->pVideoBuffer, size_t(m_curVideoData->nBufferSize));
-				m_frame->unmap();
-				emit newVideoFrame(*m_frame.get());
-			};
-			//SDL_RenderClear(m_pRender);
-			//SDL_UpdateTexture(m_pTexture, NULL, m_curVideoData->pVideoBuffer, m_curVideoData->sdlRenderLinePixelNum);
-			//SDL_RenderCopy(m_pRender, m_pTexture, NULL, &m_textureRect);
-			//SDL_RenderPresent(m_pRender);
-		}
+	case ClockAudio:
+		return m_audioClock.get(time);
+	case ClockVideo:
+		return m_videoClock.get(time);
+	default:
+		return m_externalClock.get(time);
 	}
 }
 
-void Decoder::updatePlayControlState()
+void Decoder::reportFirstFrame(int64_t presentTime)
 {
-	m_playControl.bPlayEof = m_playControl.bPlayAudioEof && m_playControl.bPlayVideoEof;
+	int64_t openTime = m_openStartTime.exchange(0);
+	if (openTime > 0)
+	{
+		m_timeToFirstFrame = (presentTime - openTime) / 1000;
+		std::cout << "[ttff]: " << m_timeToFirstFrame << " ms, open and probe " << m_probeTime / 1000
+			<< " ms, probe cache " << (m_bProbeCacheHit ? "hit" : "miss") << std::endl;
+	}
 }
 
-int Decoder::eventLoop(void* data)
+bool Decoder::isVideoLate(int64_t pts)
 {
-	Decoder* obj = static_cast<Decoder*>(data);
-	while (1)
+	// ͣʱˮֻУ
+	if (pts == AV_NOPTS_VALUE || activeClockMode() == ClockVideo || m_playControl.bPause || m_bReverse)
 	{
-		obj->updatePlayControlState();
-		if (obj->m_playControl.bPlayEof)
-			break;
-		obj->refreshVideo();
+		return false;
 	}
-	emit obj->playFinished();
-	return 0;
+	int64_t master = masterClock(av_gettime_relative());
+	return master != AV_NOPTS_VALUE &&
+		master - pts > FFMAX(m_videoFrameDuration, AV_SYNC_THRESHOLD_MIN * AV_TIME_BASE);
 }
 
-int Decoder::readThread(void* data)
+bool Decoder::dropLateVideoFrame(AVFrame* frame)
 {
-	Decoder* obj = static_cast<Decoder*>(data);
-	int ret = 0;
-	while (!obj->m_playControl.bAbort)
+	int64_t pts = frame->pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE :
+		av_rescale_q(frame->pts, m_videoCodecCtx->time_base, { 1, AV_TIME_BASE });
+	bool bLate = isVideoLate(pts);
+	m_lateStreak = bLate ? m_lateStreak + 1 : 0;
+	m_onTimeStreak = bLate ? 0 : m_onTimeStreak + 1;
+	if (m_lateStreak >= SKIP_ESCALATE_FRAMES && m_frameSkipLevel < MAX_SKIP_LEVEL)
 	{
-		ret = av_read_frame(obj->m_fmtCtx, obj->m_pRreadPkt);
-		if (ret < 0)
+		m_frameSkipLevel++;
+		m_frameSkipEscalations++;
+		m_lateStreak = 0;
+		applyFrameSkipLevel();
+	}
+	else if (m_onTimeStreak >= SKIP_RECOVER_FRAMES && m_frameSkipLevel > 0)
+	{
+		m_frameSkipLevel--;
+		m_onTimeStreak = 0;
+		applyFrameSkipLevel();
+	}
+	if (bLate && m_consecutiveDrops < MAX_CONSECUTIVE_DROPS)
+	{
+		m_consecutiveDrops++;
+		m_droppedLateFrames++;
+		return true;
+	}
+	m_consecutiveDrops = 0;
+	return false;
+}
+
+void Decoder::applyFrameSkipLevel()
+{
+	// ֡߳̽ʱһͰͬ߳
+	m_videoCodecCtx->skip_loop_filter = SKIP_LOOP_FILTER_LEVELS[m_frameSkipLevel];
+	m_videoCodecCtx->skip_frame = SKIP_FRAME_LEVELS[m_frameSkipLevel];
+}
+
+void Decoder::setPlaybackSpeed(double speed)
+{
+	speed = av_clipd(speed, MIN_PLAYBACK_SPEED, MAX_PLAYBACK_SPEED);
+	if (m_playControl.speed != (float)speed)
+	{
+		applyPlaybackSpeed((float)speed);
+		emit playbackSpeedChanged();
+	}
+}
+
+void Decoder::applyPlaybackSpeed(float speed)
+{
+	m_playControl.speed = speed;
+	m_audioClock.setSpeed(speed);
+	m_videoClock.setSpeed(speed);
+	m_externalClock.setSpeed(speed);
+}
+
+void Decoder::seek(qint64 positionMs, SeekMode mode)
+{
+	if (!m_fmtCtx)
+	{
+		return;
+	}
+	// λڲŵȡ߳̿Ѷ֮ǰ¼Ļ߽
+	SDL_LockMutex(m_playlistMutex);
+	int item = m_playlistIndex;
+	int64_t itemBase = m_playlistPresentBase;
+	m_playlistBoundaries.clear();
+	m_playlistBoundaryCount = 0;
+	SDL_UnlockMutex(m_playlistMutex);
+	int64_t target = positionMs * 1000 + itemBase;
+	SDL_LockMutex(m_playControl.seekMutex);
+	m_playControl.seekingTime = target;
+	m_playControl.bSeekAccurate = mode == SeekAccurate;
+	m_playControl.seekItem = item;
+	m_playControl.seekItemBase = itemBase;
+	m_bReviewMoved = false;
+	m_seekRequestTime = av_gettime_relative();
+	m_playControl.seekSerial++;
+	SDL_UnlockMutex(m_playControl.seekMutex);
+	// ʱӴλõĵһ֡¿ʼ
+	m_audioClock.reset();
+	m_videoClock.reset();
+	m_externalClock.reset();
+	// ѵȴݱѵĽ뻷ڣȡͽɺĵȴstateEvent
+	m_videoFrameQue.clear();
+	m_audioRing.interrupt();
+	m_playControl.stateEvent.notify();
+}
+
+void Decoder::setAudioOutput(QAudioOutput* output)
+{
+	m_audioOutput = output;
+	m_audioBytesDelivered = 0;
+}
+
+QVariantList Decoder::presentLatenessHistogram()
+{
+	QVariantList histogram;
+	for (int i = 0; i < PresentScheduler::HISTOGRAM_BUCKETS; ++i)
+	{
+		histogram.append(m_presentScheduler.histogram(i));
+	}
+	return histogram;
+}
+
+QString Decoder::activeDecodeThreadType()
+{
+	if (!m_videoCodecCtx)
+	{
+		return QString();
+	}
+	switch (m_videoCodecCtx->active_thread_type)
+	{
+	case FF_THREAD_FRAME:
+		return QString("frame");
+	case FF_THREAD_SLICE:
+		return QString("slice");
+	default:
+		return QString("none");
+	}
+}
+
+void Decoder::applyDecodeThreadConfig(AVCodecContext* codecCtx)
+{
+	switch (m_decodeThreadMode)
+	{
+	case ThreadFrame:
+		codecCtx->thread_type = FF_THREAD_FRAME;
+		break;
+	case ThreadSlice:
+		codecCtx->thread_type = FF_THREAD_SLICE;
+		break;
+	case ThreadNone:
+		codecCtx->thread_type = 0;
+		break;
+	default:
+		// ֡߳ÿһ̶߳ӳһֱֻ֡Ƭ߳
+		codecCtx->thread_type = m_bLive ? FF_THREAD_SLICE : FF_THREAD_FRAME | FF_THREAD_SLICE;
+		break;
+	}
+
+	int count = m_decodeThreadCount;
+	if (m_decodeThreadMode == ThreadNone)
+	{
+		count = 1;
+	}
+	else if (count <= 0)
+	{
+		// Զúȥˮ߳
+		count = SDL_GetCPUCount() - PIPELINE_THREAD_NUM;
+	}
+	codecCtx->thread_count = av_clip(count, 1, MAX_DECODE_THREAD_NUM);
+}
+
+void Decoder::onNewVideoFrameReceived(const QVideoFrame& frame)
+{
+	if (m_videoSurface)
+		m_videoSurface->present(frame);
+}
+
+void Decoder::openVideoStream()
+{
+	AVCodec* pVideoCdec = avcodec_find_decoder(m_pVideoCodecParam->codec_id);
+	if (pVideoCdec)
+	{
+		m_videoCodecCtx = avcodec_alloc_context3(pVideoCdec);
+		avcodec_parameters_to_context(m_videoCodecCtx, m_pVideoCodecParam);
+		applyDecodeThreadConfig(m_videoCodecCtx);
+		if (m_bLive)
+		{
+			m_videoCodecCtx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+		}
+		avcodec_open2(m_videoCodecCtx, pVideoCdec, nullptr);
+
+		m_pVideoFrame = av_frame_alloc();
+		negotiateVideoFormat();
+		connect(this, &Decoder::newVideoFrame, this, &Decoder::onNewVideoFrameReceived);
+		//m_pVideowin = SDL_CreateWindow("Decoder", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, m_pVideoCodecParam->width, m_pVideoCodecParam->height, SDL_WINDOW_OPENGL);
+		//m_pRender = SDL_CreateRenderer(m_pVideowin, -1, 0);
+		//m_pTexture = SDL_CreateTexture(m_pRender, preset[1], SDL_TEXTUREACCESS_STREAMING, m_pVideoCodecParam->width, m_pVideoCodecParam->height);
+		//m_textureRect = { 0, 0, m_pVideoCodecParam->width, m_pVideoCodecParam->height };
+	}
+}
+
+void Decoder::negotiateVideoFormat()
+{
+	AVPixelFormat srcFmt = m_videoCodecCtx->pix_fmt;
+	QList<QVideoFrame::PixelFormat> supported;
+	if (m_videoSurface)
+	{
+		supported = m_videoSurface->supportedPixelFormats();
+	}
+	if (supported.isEmpty())
+	{
+		supported.append(QVideoFrame::Format_YUV420P);
+	}
+
+	m_videoOutFmt = AV_PIX_FMT_NONE;
+	QVideoFrame::PixelFormat srcQtFmt = AVFrameVideoBuffer::toQtPixelFormat(srcFmt);
+	if (srcQtFmt != QVideoFrame::Format_Invalid && supported.contains(srcQtFmt))
+	{
+		m_videoOutFmt = srcFmt; // surfaceֱʾҪת
+	}
+	else
+	{
+		for (QVideoFrame::PixelFormat fmt : PREFERRED_PIXEL_FORMATS)
+		{
+			if (supported.contains(fmt))
+			{
+				m_videoOutFmt = (AVPixelFormat)AVFrameVideoBuffer::toAVPixelFormat(fmt);
+				break;
+			}
+		}
+	}
+	if (m_videoOutFmt == AV_PIX_FMT_NONE)
+	{
+		m_videoOutFmt = (AVPixelFormat)preset[0];
+	}
+	m_videoOutBufferSize = av_image_get_buffer_size(m_videoOutFmt, m_pVideoCodecParam->width, m_pVideoCodecParam->height, 1);
+
+	const char* srcName = av_get_pix_fmt_name(srcFmt);
+	const char* outName = av_get_pix_fmt_name(m_videoOutFmt);
+	std::string path = srcFmt == m_videoOutFmt
+		? std::string("passthrough ") + outName
+		: std::string("sws ") + (srcName ? srcName : "unknown") + "->" + outName;
+	m_videoConvertPath = QString::fromStdString(path);
+
+	setFormat(m_pVideoCodecParam->width, m_pVideoCodecParam->height, AVFrameVideoBuffer::toQtPixelFormat(m_videoOutFmt));
+}
+
+AVFrame* Decoder::convertVideoFrame(AVFrame* srcFrame, SwsContext** swsCtx)
+{
+	int outWidth = m_pVideoCodecParam->width;
+	int outHeight = m_pVideoCodecParam->height;
+	// ʽͳߴ綼surfaceһ£ֱý֡
+	if (srcFrame->format == m_videoOutFmt && srcFrame->width == outWidth && srcFrame->height == outHeight)
+	{
+		m_videoPassthroughFrames++;
+		return av_frame_clone(srcFrame);
+	}
+
+	// Դʽֱʱ仯ʱsws_getCachedContextؽ
+	*swsCtx = sws_getCachedContext(*swsCtx,
+		srcFrame->width, srcFrame->height, (AVPixelFormat)srcFrame->format,
+		outWidth, outHeight, m_videoOutFmt,
+		SWS_BICUBIC, nullptr, nullptr, nullptr);
+	if (!*swsCtx)
+	{
+		return nullptr;
+	}
+	// ֱתõbuffer֮֡ôݵsurface
+	AVFrame* outFrame = av_frame_alloc();
+	outFrame->buf[0] = m_framePool.get(m_videoOutBufferSize);
+	outFrame->format = m_videoOutFmt;
+	outFrame->width = outWidth;
+	outFrame->height = outHeight;
+	outFrame->pts = srcFrame->pts;
+	av_image_fill_arrays(outFrame->data,
+		outFrame->linesize,
+		outFrame->buf[0]->data,
+		m_videoOutFmt,
+		outWidth,
+		outHeight, 1);
+	sws_scale(
+		*swsCtx,
+		(const uint8_t* const*)srcFrame->data, srcFrame->linesize,
+		0, srcFrame->height,
+		outFrame->data, outFrame->linesize);
+	m_videoConvertedFrames++;
+	return outFrame;
+}
+
+void Decoder::openAudioStream()
+{
+	AVCodec* pAudioCdec = avcodec_find_decoder(m_pAudioCodecParam->codec_id);
+	if (pAudioCdec)
+	{
+		m_audioCodecCtx = avcodec_alloc_context3(pAudioCdec);
+		avcodec_parameters_to_context(m_audioCodecCtx, m_pAudioCodecParam);
+		m_audioCodecCtx->pkt_timebase = m_fmtCtx->streams[m_nAudioInx]->time_base;
+		avcodec_open2(m_audioCodecCtx, pAudioCdec, nullptr);
+		m_swrCtx = swr_alloc_set_opts(m_swrCtx,
+			m_pAudioCodecParam->channel_layout, (AVSampleFormat)m_audioFormatPreset[0], m_pAudioCodecParam->sample_rate,
+			m_pAudioCodecParam->channel_layout, (AVSampleFormat)m_pAudioCodecParam->format, m_pAudioCodecParam->sample_rate,
+			-1, nullptr);
+		swr_init(m_swrCtx);
+		
+		m_settingSpec.freq = m_pAudioCodecParam->sample_rate;
+		m_settingSpec.format = m_audioFormatPreset[1];
+		m_settingSpec.channels = m_pAudioCodecParam->channels;
+		m_settingSpec.samples = m_pAudioCodecParam->frame_size;
+		m_settingSpec.silence = 0;
+		m_settingSpec.callback = audioCallback;
+		m_settingSpec.userdata = this;
+
+		//SDL_AudioSpec realSpec;
+		//SDL_OpenAudio(&m_settingSpec, nullptr);
+
+ 		//SDL_PauseAudio(0);
+
+		m_audioFormat.setCodec("audio/pcm");
+		m_audioFormat.setSampleRate(m_pAudioCodecParam->sample_rate);
+		m_audioFormat.setSampleSize(av_get_bytes_per_sample((AVSampleFormat)m_audioFormatPreset[0])*8);
+		m_audioFormat.setSampleType(QAudioFormat::SignedInt);
+		m_audioFormat.setChannelCount(m_pAudioCodecParam->channels);
+		m_audioFormat.setByteOrder(QAudioFormat::LittleEndian);
+
+		m_pAudioFrame = av_frame_alloc();
+		m_nChannelFormatByte =
+			m_settingSpec.channels * av_get_bytes_per_sample((AVSampleFormat)m_audioFormatPreset[0]);
+	}
+}
+
+bool Decoder::openStream(std::string filePath)
+{
+#ifdef SAVEPCM
+	g_pcmFp = fopen("C:/Users/1/Desktop/test.pcm", "wb");
+#endif
+
+	int ret = 0;
+	m_openStartTime = av_gettime_relative();
+	m_timeToFirstFrame = 0;
+	// Ԥӳ򻺴ʧʱffmpegֱӴ
+	AVIOContext* pb = nullptr;
+	if (MmapIO::isLocalPath(filePath))
+	{
+		if (m_readAheadSize > 0 && m_readAheadIO.open(filePath, m_readAheadSize * (1024 * 1024 / ReadAheadIO::CHUNK_SIZE), m_ioThrottle))
+		{
+			pb = m_readAheadIO.avioContext();
+		}
+		else if (m_bMmapIO && m_mmapIO.open(filePath))
+		{
+			pb = m_mmapIO.avioContext();
+		}
+	}
+	else if (m_bHttpCache && HttpCacheIO::isHttpUrl(filePath))
+	{
+		std::string cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString() + "/http";
+		if (m_httpCacheIO.open(filePath, cacheDir, (int64_t)m_httpCacheBudget * 1024 * 1024))
+		{
+			pb = m_httpCacheIO.avioContext();
+		}
+	}
+	bool bAbrHook = m_bAbr && !MmapIO::isLocalPath(filePath);
+	m_bLive = m_liveMode == LiveOn || (m_liveMode == LiveAuto && isLiveUrl(filePath));
+	if (pb || bAbrHook || m_bLive)
+	{
+		m_fmtCtx = avformat_alloc_context();
+	}
+	if (pb)
+	{
+		m_fmtCtx->pb = pb;
+		m_fmtCtx->flags |= AVFMT_FLAG_CUSTOM_IO;
+	}
+	AVDictionary* options = nullptr;
+	if (bAbrHook)
+	{
+		// ڷƬӵĴ򿪺͹رϲ̽ڼصķƬҲΪʼ
+		// hlshttp־ӻͬһAVIOContextƬصƬ
+		m_fmtCtx->opaque = this;
+		m_defaultIoOpen = m_fmtCtx->io_open;
+		m_defaultIoClose = m_fmtCtx->io_close;
+		m_fmtCtx->io_open = abrIoOpen;
+		m_fmtCtx->io_close = abrIoClose;
+		av_dict_set(&options, "http_persistent", "0", 0);
+	}
+	if (m_bLive)
+	{
+		// ֻ̽⵽ܴ򿪽Ϊֹİavformatڲ
+		m_fmtCtx->interrupt_callback.callback = abortInterruptCallback;
+		m_fmtCtx->interrupt_callback.opaque = this;
+		m_fmtCtx->flags |= AVFMT_FLAG_NOBUFFER;
+		m_fmtCtx->probesize = LIVE_PROBE_SIZE;
+		m_fmtCtx->max_analyze_duration = LIVE_ANALYZE_DURATION;
+		m_fmtCtx->max_delay = (int)LIVE_MAX_DELAY;
+		av_dict_set_int(&options, "rw_timeout", LIVE_RW_TIMEOUT, 0);
+		std::cout << "[live]: target latency " << m_liveTargetLatency << " ms" << std::endl;
+	}
+	m_ioBusyStart = av_gettime_relative();
+	ret = avformat_open_input(&m_fmtCtx, filePath.c_str(), nullptr, &options);
+	av_dict_free(&options);
+	if (ret < 0)
+	{
+		outputError("avformat_open_input", ret);
+		return false;
+	}
+
+	// demuxerһʱֱʹã̽Ⲣ»
+	bool bProbeCache = m_bProbeCache && !m_bLive && MmapIO::isLocalPath(filePath) &&
+		m_probeCache.open(filePath, QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString() + "/probe");
+	m_bProbeCacheHit = bProbeCache && m_probeCache.load(m_fmtCtx);
+	if (!m_bProbeCacheHit)
+	{
+		ret = avformat_find_stream_info(m_fmtCtx, nullptr);
+		if (ret < 0)
+		{
+			outputError("avformat_open_input", ret);
+			return false;
+		}
+		if (bProbeCache)
+		{
+			m_probeCache.store(m_fmtCtx);
+		}
+	}
+	m_ioBusyTime += av_gettime_relative() - m_ioBusyStart;
+	m_ioBusyStart = 0;
+	m_probeTime = av_gettime_relative() - m_openStartTime;
+
+	for (int i = 0; i < m_fmtCtx->nb_streams; ++i)
+	{
+		if (m_fmtCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+		{
+			m_nAudioInx = i;
+			m_pAudioCodecParam = m_fmtCtx->streams[i]->codecpar;
+		}
+		if (m_fmtCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+		{
+			m_nVideoInx = i;
+			m_pVideoCodecParam = m_fmtCtx->streams[i]->codecpar;
+		}
+	}
+
+	// ʱ̽ڼѡʼvariantdiscardhls
+	// ߴ簴һʶֻǻؽsurface
+	if (bAbrHook && m_abr.init(m_fmtCtx))
+	{
+		int start = FFMAX(m_abr.select(0, av_gettime_relative()), 0);
+		const AbrController::Variant& first = m_abr.variant(start);
+		const AbrController::Variant& top = m_abr.variant(m_abr.highest());
+		m_nVideoInx = first.videoIndex;
+		m_pVideoCodecParam = m_fmtCtx->streams[top.videoIndex]->codecpar;
+		m_videoBatch.streamIndex = top.videoIndex; // ʼvariantĵһʱ
+		if (first.audioIndex >= 0)
+		{
+			m_nAudioInx = first.audioIndex;
+			m_pAudioCodecParam = m_fmtCtx->streams[first.audioIndex]->codecpar;
+		}
+		m_abr.setCurrent(start, av_gettime_relative());
+		m_abr.applyDiscard(m_fmtCtx, start, -1);
+	}
+
+	// Ƶڵ
+	if (m_nAudioInx == -1 && m_nVideoInx == -1)
+	{
+		std::cout << "m_nAudioInx == -1 && m_nVideoInx == -1" << std::endl;
+		return false;
+	}
+
+	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER);
+	// Ƶؽṹ
+	if (m_nAudioInx >= 0)
+	{
+		openAudioStream();
+	}
+	// Ƶؽṹ
+	if (m_nVideoInx >= 0)
+	{
+		openVideoStream();
+	}
+
+	// ߳cacheޣ߳
+	evalCacheMax();
+	if (m_audioCodecCtx)
+	{
+		m_audioRing.init(m_audioCacheMaxByte, m_nChannelFormatByte * m_settingSpec.freq);
+		m_audioRing.bAbort = false;
+	}
+	// һʱƫƣ֮
+	int64_t startTime = m_fmtCtx->start_time != AV_NOPTS_VALUE ? m_fmtCtx->start_time : 0;
+	m_playlistItemBase = startTime;
+	m_playlistPresentBase = startTime;
+	m_playlistItemEnd = m_fmtCtx->duration != AV_NOPTS_VALUE ? startTime + m_fmtCtx->duration : AV_NOPTS_VALUE;
+	m_playlistReadIndex = m_playlistIndex;
+
+	m_bReviewable = MmapIO::isLocalPath(filePath) && !m_bLive && m_fmtCtx->pb && (m_fmtCtx->pb->seekable & AVIO_SEEKABLE_NORMAL);
+	// ߳һAVFormatContextɨļԴأֱɨ
+	// ְֽ֧seekĸʽҲò
+	if (m_bKeyframeIndex && m_videoCodecCtx && MmapIO::isLocalPath(filePath) && !m_bLive &&
+		!(m_fmtCtx->iformat->flags & AVFMT_NO_BYTE_SEEK))
+	{
+		m_keyframeIndex.open(filePath, m_nVideoInx);
+	}
+
+	m_pRreadPkt = m_packetPool.acquire();
+	if (m_bSharedScheduler)
+	{
+		// Ƶȣ·ͬʱʱ
+		DecodeScheduler* scheduler = DecodeScheduler::instance();
+		if (m_audioCodecCtx)
+		{
+			m_audioDecTask = scheduler->submit([this] { return audioDecodeStep(false); }, DecodeScheduler::Priority::HIGH);
+		}
+		if (m_videoCodecCtx)
+		{
+			m_videoDecTask = scheduler->submit([this] { return videoDecodeStep(false); }, DecodeScheduler::Priority::NORMAL);
+		}
+		m_readTask = scheduler->submit([this] { return readStep(false); }, DecodeScheduler::Priority::NORMAL);
+		// ָ֮ǰ֪ͨûлѵѹһ
+		wakeTask(m_audioDecTask);
+		wakeTask(m_videoDecTask);
+		wakeTask(m_readTask);
+	}
+	else
+	{
+		if (m_audioCodecCtx)
+		{
+			m_audioDecThread = SDL_CreateThread(audioDecodeThread, "audioDecode", this);
+		}
+		if (m_videoCodecCtx)
+		{
+			m_videoDecThread = SDL_CreateThread(videoDecodeThread, "videoDecode", this);
+		}
+		m_readThread = SDL_CreateThread(readThread, "readData", this);
+	}
+	m_eventLoopThread = SDL_CreateThread(eventLoop, "eventLoop", this);
+
+	emit dataReady();
+
+	return m_nAudioInx >= 0 || m_nVideoInx >= 0; // Ƶ
+}
+
+void Decoder::closeVideoStream()
+{
+	if (m_videoCodecCtx)
+	{
+		SDL_WaitThread(m_videoDecThread, NULL);
+		waitTask(m_videoDecTask);
+		sws_freeContext(m_swsCtx);
+		sws_freeContext(m_reviewSwsCtx);
+		m_reviewSwsCtx = nullptr;
+		av_frame_free(&m_pVideoFrame);
+		avcodec_free_context(&m_videoCodecCtx);
+		for (AVCodecContext*& codecCtx : m_retiredVideoCtx)
+		{
+			avcodec_free_context(&codecCtx);
+		}
+		m_retiredVideoCtx.clear();
+
+		/*SDL_DestroyTexture(m_pTexture);
+		SDL_DestroyRenderer(m_pRender);
+		SDL_DestroyWindow(m_pVideowin);*/
+	}
+}
+
+void Decoder::closeAudioStream()
+{
+	if (m_audioCodecCtx)
+	{
+		SDL_WaitThread(m_audioDecThread, NULL);
+		waitTask(m_audioDecTask);
+		//SDL_CloseAudio();
+		swr_close(m_swrCtx);
+		av_freep(&m_audioConvertBuf);
+		m_audioTempo.close();
+		av_frame_free(&m_pAudioFrame);
+		avcodec_free_context(&m_audioCodecCtx);
+		for (AVCodecContext*& codecCtx : m_retiredAudioCtx)
+		{
+			avcodec_free_context(&codecCtx);
+		}
+		m_retiredAudioCtx.clear();
+	}
+}
+
+void Decoder::closeStream()
+{
+	m_playControl.bAbort = true;
+	m_httpCacheIO.abort(); // ȡ߳̿ȡ
+	m_gopCache.abort(); // eventLoopڵȴGOP룬˳close
+	m_presentScheduler.abort();
+	m_audioPktQue.abort();
+	m_videoPktQue.abort();
+	m_audioRing.abort();
+	m_videoFrameQue.abort();
+	m_playControl.stateEvent.notify();
+	// Ԥ̲߳յǰĽһڽͷţڴʱжϻص
+	SDL_LockMutex(m_playlistMutex);
+	SDL_Thread* preroll = m_prerollThread;
+	m_prerollThread = nullptr;
+	SDL_UnlockMutex(m_playlistMutex);
+	SDL_WaitThread(preroll, NULL);
+	closeAudioStream();
+	closeVideoStream();
+	SDL_WaitThread(m_readThread, NULL);
+	waitTask(m_readTask);
+	m_keyframeIndex.close(); // ȡ߳seekʱ˳ͷ
+	SDL_WaitThread(m_eventLoopThread, NULL);
+	m_gopCache.close(); // eventLoop˳ٷ
+	m_packetPool.release(m_pRreadPkt);
+	m_pRreadPkt = nullptr;
+	std::cout << "[packet pool]: alloc " << m_packetPool.allocCount << " reuse " << m_packetPool.reuseCount << std::endl;
+	std::cout << "[present lateness]: " << m_presentScheduler.summary() << std::endl;
+	std::cout << "[frame drop]: late " << m_droppedLateFrames << " present " << m_droppedPresentFrames
+		<< " skip escalations " << m_frameSkipEscalations << std::endl;
+	if (m_demuxTime > 0)
+	{
+		std::cout << "[demux]: " << m_demuxPackets << " packets " << m_demuxBytes / (1024 * 1024) << " MB in "
+			<< m_demuxTime / 1000 << " ms, " << m_demuxPackets * AV_TIME_BASE / m_demuxTime << " packets/s "
+			<< (double)m_demuxBytes / (1024 * 1024) * AV_TIME_BASE / m_demuxTime << " MB/s" << std::endl;
+	}
+	// ÿδ򿪵ͳƣmmapĬI/OܰļԱ
+	m_demuxPackets = 0;
+	m_demuxBytes = 0;
+	m_demuxTime = 0;
+	if (m_abr.isEnabled())
+	{
+		std::cout << "[abr]: switches up " << m_abr.upSwitches() << " down " << m_abr.downSwitches()
+			<< ", average " << m_abr.averageBitrate() / 1000 << " kbps, rebuffer " << m_rebufferTime / 1000 << " ms" << std::endl;
+	}
+	m_preparedAudioCodecs.clear();
+	m_preparedVideoCodecs.clear();
+	freePlaylistItem(m_prerollItem);
+	m_prerollItem = nullptr;
+	m_bPrerolling = false;
+	while (SDL_SemTryWait(m_prerollDone) == 0)
+	{
+	}
+	avformat_close_input(&m_playlistCtx);
+	m_playlistStreamBase = 0;
+	m_playlistOffset = 0;
+	m_playlistReadEnd = AV_NOPTS_VALUE;
+	m_playlistItemBase = 0;
+	m_playlistPresentBase = 0;
+	m_presentItemCount = 0;
+	SDL_LockMutex(m_playlistMutex);
+	m_playlistBoundaries.clear();
+	m_playlistBoundaryCount = 0;
+	SDL_UnlockMutex(m_playlistMutex);
+	m_abr.reset();
+	m_abrSwitching = -1;
+	m_abrReadPts = AV_NOPTS_VALUE;
+	if (m_bLive)
+	{
+		std::cout << "[live]: catch ups " << m_liveCatchUps << ", last latency " << m_liveLatency / 1000 << " ms" << std::endl;
+	}
+	m_bLive = false;
+	m_liveReadPts = AV_NOPTS_VALUE;
+	m_liveLatency = 0;
+	m_liveCatchUps = 0;
+	m_liveLastCheck = 0;
+	m_liveCatchUpTime = 0;
+	if (m_bLiveSpeedUp)
+	{
+		applyPlaybackSpeed(1.0f);
+		m_bLiveSpeedUp = false;
+	}
+	m_ioBusyStart = 0;
+	avformat_close_input(&m_fmtCtx);
+	m_mmapIO.close();
+	m_readAheadIO.close();
+	m_httpCacheIO.close();
+	resetStreamState();
+}
+
+void Decoder::resetStreamState()
+{
+	// ָѹرյm_fmtCtxһļȱٵٸֵ
+	m_nAudioInx = -1;
+	m_nVideoInx = -1;
+	m_pAudioCodecParam = nullptr;
+	m_pVideoCodecParam = nullptr;
+	m_videoClk = 0;
+	m_videoFrameDuration = 0;
+	m_playControl.bAbort = false;
+	m_playControl.bReadEof = false;
+	m_playControl.bAudioDecodeEof = false;
+	m_playControl.bVideoDecodeEof = false;
+	m_playControl.seek();
+	// ڴӵǰseekſʼѹرǰseekµ
+	int serial = m_playControl.seekSerial;
+	m_readSerial = serial;
+	m_audioSerial = serial;
+	m_videoSerial = serial;
+	m_presentSerial = serial;
+	m_reviewSerial = serial;
+	m_audioCatchUpSerial = m_liveCatchUpSerial;
+	m_videoCatchUpSerial = m_liveCatchUpSerial;
+	m_audioPktQue.reset();
+	m_videoPktQue.reset();
+	m_audioRing.reset();
+	m_videoFrameQue.reset();
+	m_presentScheduler.resume();
+	m_audioBatch.reset();
+	m_videoBatch.reset();
+	m_pReadPendingQue = nullptr;
+	m_bReadEnd = false;
+	m_readEndQueued = 0;
+	m_audioRecRet = 0;
+	m_videoRecRet = 0;
+	m_bAudioFramePending = false;
+	m_audioDropUntil = AV_NOPTS_VALUE;
+	m_audioLastEnd = AV_NOPTS_VALUE;
+	m_videoDropUntil = AV_NOPTS_VALUE;
+	m_videoLastPts = AV_NOPTS_VALUE;
+	m_bVideoDiscontinuity = false;
+	m_frameSkipLevel = 0;
+	m_lateStreak = 0;
+	m_onTimeStreak = 0;
+	m_consecutiveDrops = 0;
+	m_consecutivePresentDrops = 0;
+	// m_lastVideoDataΪջm_curVideoDataͬ
+	delete m_curVideoData;
+	m_curVideoData = nullptr;
+	m_lastVideoData = nullptr;
+	m_bInReview = false;
+	m_bReviewMoved = false;
+	m_bLiveResumed = false;
+	m_rebufferStart = 0;
+	m_audioClock.reset();
+	m_videoClock.reset();
+	m_externalClock.reset();
+}
+
+size_t Decoder::readAudio(uint8_t* stream, size_t len, int64_t deviceLatency)
+{
+	// رյ´֮价ζдabort
+	if (m_audioRing.bAbort)
+	{
+		return 0;
+	}
+	// Ƶ뻹δseekʱǾݣʱ
+	bool bCurrent = m_audioSerial == m_playControl.seekSerial;
+	int64_t clock = AV_NOPTS_VALUE;
+	size_t readLen = m_audioRing.read(stream, len, &clock);
+	if (bCurrent && clock != AV_NOPTS_VALUE)
+	{
+		// clockǱݵ㣬豸еݲֵ
+		int64_t now = av_gettime_relative();
+		int64_t playing = clock - (int64_t)(deviceLatency * m_playControl.speed);
+		m_audioClock.set(playing, now);
+		if (!m_externalClock.isValid())
+		{
+			m_externalClock.set(playing, now);
+		}
+		if (!m_videoCodecCtx)
+		{
+			reportFirstFrame(now + deviceLatency);
+		}
+	}
+	return readLen;
+}
+
+int64_t Decoder::audioDeviceLatency()
+{
+	if (!m_audioOutput)
+	{
+		return 0;
+	}
+	int64_t bytesPerSec = m_nChannelFormatByte * m_settingSpec.freq;
+	int64_t deliveredUs = m_audioBytesDelivered * AV_TIME_BASE / bytesPerSec;
+	int64_t maxBufferedUs = (int64_t)m_audioOutput->bufferSize() * AV_TIME_BASE / bytesPerSec;
+	return av_clip64(deliveredUs - m_audioOutput->processedUSecs(), 0, maxBufferedUs);
+}
+
+bool Decoder::playAudioEof()
+{
+	return m_audioSerial == m_playControl.seekSerial && m_playControl.bAudioDecodeEof && m_audioRing.size() == 0;
+}
+
+qint64 Decoder::readData(char* stream, qint64 len)
+{
+	// ͣ򲥷ʱ
+	if (m_playControl.bPause || m_bReverse)
+	{
+		memset(stream, 0, len);
+		m_audioBytesDelivered += len;
+		return len;
+	}
+	if (playAudioEof())
+	{
+		m_playControl.bPlayAudioEof = true;
+		m_playControl.stateEvent.notify();
+		memset(stream, 0, len);
+		return 0;
+	}
+	size_t readLen = readAudio((uint8_t*)stream, len, audioDeviceLatency());
+	memset(stream + readLen, 0, len - readLen); // ݲ㲹
+	m_audioBytesDelivered += len;
+	return len;
+}
+
+void Decoder::audioCallback(void* userdata, Uint8* stream, int len)
+{
+	Decoder* obj = static_cast<Decoder*>(userdata);
+	if (obj->m_playControl.bPause || obj->m_bReverse)
+	{
+		memset(stream, 0, len);
+		return;
+	}
+	if (obj->playAudioEof())
+	{
+		obj->m_playControl.bPlayAudioEof = true;
+		obj->m_playControl.stateEvent.notify();
+		memset(stream, 0, len);
+		return;
+	}
+	// SDLصʱ豸Լһδ
+	int64_t latency = obj->m_settingSpec.freq > 0 ? (int64_t)obj->m_settingSpec.samples * AV_TIME_BASE / obj->m_settingSpec.freq : 0;
+	size_t readLen = obj->readAudio(stream, len, latency);
+	memset(stream + readLen, 0, len - readLen);
+}
+
+int64_t Decoder::videoSyncClock(int64_t lastPts)
+{
+	int64_t duration = m_videoClk - lastPts; // һ֡ĳʱ
+	if (duration <= 0 || duration > AV_NOSYNC_THRESHOLD * AV_TIME_BASE)
+	{
+		duration = m_videoFrameDuration;
+	}
+	// ƵΪʱʱptsʾ
+	if (activeClockMode() == ClockVideo)
+	{
+		return duration;
+	}
+	int64_t now = av_gettime_relative();
+	int64_t master = masterClock(now);
+	int64_t video = m_videoClock.get(now);
+	if (master == AV_NOPTS_VALUE || video == AV_NOPTS_VALUE)
+	{
+		return duration;
+	}
+	int64_t diff = video - master;
+	int64_t sync_threshold = FFMAX(AV_SYNC_THRESHOLD_MIN * AV_TIME_BASE, FFMIN(AV_SYNC_THRESHOLD_MAX * AV_TIME_BASE, duration));
+	if (FFABS(diff) >= AV_NOSYNC_THRESHOLD * AV_TIME_BASE)
+	{
+		return duration;
+	}
+	if (diff <= -sync_threshold)
+	{
+		duration = FFMAX(0, duration + diff);
+	}
+	else if (diff >= sync_threshold && duration > AV_SYNC_FRAMEDUP_THRESHOLD * AV_TIME_BASE)
+	{
+		duration = duration + diff;
+	}
+	else if (diff >= sync_threshold)
+	{
+		duration = 2 * duration;
+	}
+	return duration;
+}
+
+bool Decoder::playVideoEof()
+{
+	return m_videoSerial == m_playControl.seekSerial && m_playControl.bVideoDecodeEof &&
+		m_videoFrameQue.getCurState() == QueueState::EMPTY;
+}
+
+void Decoder::evalCacheMax()
+{
+	if (m_audioCodecCtx)
+	{
+		int oneSecAudioByte = m_nChannelFormatByte* m_settingSpec.freq;
+		m_audioCacheMaxByte = oneSecAudioByte * PRELOADSEC;
+	}
+	if (m_videoCodecCtx)
+	{
+		// ֡Ƿ30000/1001ֻ֮ȡӻǧ
+		AVRational frameRate = av_guess_frame_rate(m_fmtCtx, m_fmtCtx->streams[m_nVideoInx], nullptr);
+		frameRate = frameRate.num > 0 && frameRate.den > 0 ? frameRate : m_videoCodecCtx->framerate;
+		frameRate = frameRate.num > 0 && frameRate.den > 0 ? frameRate : AVRational{ 30, 1 };
+		int fps = FFMAX((int)(av_q2d(frameRate) + 0.5), 1);
+		int oneVideoFrameByte = m_pVideoCodecParam->width* m_pVideoCodecParam->height * 3 / 2;
+		int oneSecVideoByte = oneVideoFrameByte * fps;
+		m_videoCacheMaxByte = oneSecVideoByte * PRELOADSEC;
+		m_videoFrameDuration = av_rescale_q(1, av_inv_q(frameRate), { 1, AV_TIME_BASE });
+	}	
+}
+
+void Decoder::refreshVideo()
+{
+	if (m_videoCodecCtx)
+	{
+		if (playVideoEof())
+		{
+			if (m_curVideoData)
+			{
+				delete m_curVideoData;
+				m_curVideoData = nullptr;
+			}
+			m_playControl.bPlayVideoEof = true;
+			return;
+		}
+		m_lastVideoData = m_curVideoData;
+		if (m_videoFrameQue.waitPop(&m_curVideoData, REFRESH_WAIT_MS) != QueueState::NORMAL)
+		{
+			// ѿʼź֡ȡ٣𲥺seekȵһ֡
+			if (!m_rebufferStart && m_videoClock.isValid() && !m_playControl.bVideoDecodeEof)
+			{
+				m_rebufferStart = av_gettime_relative();
+			}
+		}
+		else
+		{
+			if (m_rebufferStart)
+			{
+				m_rebufferTime += av_gettime_relative() - m_rebufferStart;
+				m_rebufferStart = 0;
+			}
+			if (m_lastVideoData)
+			{
+				delete m_lastVideoData;
+				m_lastVideoData = nullptr;
+			}
+			// seek֮ǰ֡ʾ´ˢʱͷ
+			if (m_curVideoData->serial != m_playControl.seekSerial)
+			{
+				return;
+			}
+			// seekָͣĵһ֡ʾ֮ǰĿʱۼ
+			if (m_curVideoData->serial != m_presentSerial || m_resumeSerial != m_presentResumeSerial)
+			{
+				m_presentSerial = m_curVideoData->serial;
+				m_presentResumeSerial = m_resumeSerial;
+				m_presentScheduler.reset();
+			}
+			int64_t lastClk = m_videoClk;
+			m_videoClk = av_rescale_q(m_curVideoData->framePts, m_videoCodecCtx->time_base, { 1, AV_TIME_BASE });
+			// ֱ׷Ϻptsǰ䣬ʾⲿʱӸλ
+			if (m_curVideoData->bDiscontinuity)
+			{
+				lastClk = m_videoClk;
+				m_presentScheduler.reset();
+				m_externalClock.reset();
+			}
+			//m_videoClk = m_videoClk * av_q2d({ 1, AV_TIME_BASE });
+			// ѹҺ滹֡ʱʾ´ˢʱͷţһ޷һ֡ȥ
+			if (isVideoLate(m_videoClk) && m_videoFrameQue.getCurState() != QueueState::EMPTY &&
+				m_consecutivePresentDrops < MAX_CONSECUTIVE_DROPS)
+			{
+				m_consecutivePresentDrops++;
+				m_droppedPresentFrames++;
+				return;
+			}
+			m_consecutivePresentDrops = 0;
+			// Ŀʱһ֡Ŀۼӣ˯ۻƯ
+			// ýʱ䰴ٶȻʵʼ
+			int64_t interval = (int64_t)(videoSyncClock(lastClk) / m_playControl.speed);
+			int64_t target = m_presentScheduler.nextTarget(interval, AV_SYNC_THRESHOLD_MAX * AV_TIME_BASE);
+			int64_t presentTime = target + m_presentScheduler.waitUntil(target);
+			m_videoClock.set(m_videoClk, presentTime);
+			if (!m_externalClock.isValid())
+			{
+				m_externalClock.set(m_videoClk, presentTime);
+			}
+			int64_t master = masterClock(presentTime);
+			if (master != AV_NOPTS_VALUE)
+			{
+				m_avDrift = m_videoClk - master;
+			}
+			// QVideoFrameAVFrameãsurfaceֱӳƽ
+			AVFrame* pFrame = m_curVideoData->pFrame;
+			QVideoFrame frame(new AVFrameVideoBuffer(pFrame),
+				QSize(pFrame->width, pFrame->height),
+				AVFrameVideoBuffer::toQtPixelFormat(pFrame->format));
+			emit newVideoFrame(frame);
+			reportFirstFrame(presentTime);
+			int64_t requestTime = m_seekRequestTime.exchange(0);
+			if (requestTime > 0)
+			{
+				m_lastSeekLatency = (presentTime - requestTime) / 1000;
+			}
+			//SDL_RenderClear(m_pRender);
+			//SDL_UpdateTexture(m_pTexture, NULL, m_curVideoData->pFrame->data[0], m_curVideoData->sdlRenderLinePixelNum);
+			//SDL_RenderCopy(m_pRender, m_pTexture, NULL, &m_textureRect);
+			//SDL_RenderPresent(m_pRender);
+		}
+	}
+}
+
+void Decoder::refreshReview()
+{
+	if (m_playControl.bAbort)
+	{
+		return;
+	}
+	if (!m_gopCache.isOpen() && !m_gopCache.open(m_filePath, m_nVideoInx, m_videoCodecCtx->thread_count,
+		[this](AVFrame* frame) { return convertVideoFrame(frame, &m_reviewSwsCtx); }))
+	{
+		std::cout << "[gop cache]: open failed" << std::endl;
+		m_playControl.stateEvent.wait([this] { return m_playControl.bAbort; }, EVENT_WAIT_MS);
+		return;
+	}
+	AVFrame* frame = nullptr;
+	int serial = m_playControl.seekSerial;
+	int step = m_stepRequest.exchange(0);
+	if (serial != m_reviewSerial)
+	{
+		// ͣseekʾĿ괦֡
+		int64_t target = 0;
+		bool bAccurate = true;
+		m_reviewSerial = m_playControl.currentSeek(&target, &bAccurate);
+		frame = m_gopCache.frameAfter(target - 1);
+		m_presentScheduler.reset();
+	}
+	else if (step != 0)
+	{
+		int64_t pts = m_videoClk;
+		for (int i = 0; i < FFABS(step); ++i)
+		{
+			AVFrame* next = step > 0 ? m_gopCache.frameAfter(pts) : m_gopCache.frameBefore(pts);
+			if (!next)
+			{
+				break; // ͷ
+			}
+			av_frame_free(&frame);
+			frame = next;
+			pts = frame->pts;
+		}
+		m_presentScheduler.reset();
+		m_bReviewMoved = frame != nullptr || m_bReviewMoved;
+	}
+	else if (m_bReverse && !m_playControl.bPause)
+	{
+		frame = m_gopCache.frameBefore(m_videoClk);
+		if (!frame)
+		{
+			// 򵽿ͷͣڵһ֡
+			m_playControl.bPause = true;
+			emit pausedChanged();
+			return;
+		}
+		m_bReviewMoved = true;
+	}
+	else
+	{
+		m_playControl.stateEvent.wait([this, serial] {
+			return m_stepRequest != 0 || m_playControl.seekSerial != serial || !m_playControl.bPause ||
+				m_playControl.bAbort;
+		}, EVENT_WAIT_MS);
+		return;
+	}
+	if (!frame)
+	{
+		return;
+	}
+	// ʱptsʾʱ
+	int64_t interval = m_videoClk - frame->pts;
+	if (interval <= 0 || interval > AV_NOSYNC_THRESHOLD * AV_TIME_BASE)
+	{
+		interval = m_videoFrameDuration;
+	}
+	m_videoClk = frame->pts;
+	int64_t target = m_presentScheduler.nextTarget((int64_t)(interval / m_playControl.speed), AV_SYNC_THRESHOLD_MAX * AV_TIME_BASE);
+	m_presentScheduler.waitUntil(target);
+	QVideoFrame videoFrame(new AVFrameVideoBuffer(frame),
+		QSize(frame->width, frame->height),
+		AVFrameVideoBuffer::toQtPixelFormat(frame->format));
+	emit newVideoFrame(videoFrame);
+	av_frame_free(&frame);
+}
+
+void Decoder::updatePlayControlState()
+{
+	m_playControl.bPlayEof = m_playControl.bPlayAudioEof && m_playControl.bPlayVideoEof;
+}
+
+int Decoder::eventLoop(void* data)
+{
+	Decoder* obj = static_cast<Decoder*>(data);
+	int serial = obj->m_playControl.seekSerial;
+	bool bFinished = false;
+	while (!obj->m_playControl.bAbort)
+	{
+		if (obj->m_playControl.seekSerial != serial)
+		{
+			serial = obj->m_playControl.seekSerial;
+			obj->m_playControl.seek();
+			bFinished = false;
+		}
+		if (obj->m_playlistBoundaryCount > 0)
+		{
+			obj->updatePlaylistIndex();
+		}
+		// GopCacheһļ룬֮ͲGopCacheԴͣʱֻͣڵǰַ֧֡Ͳ
+		if (obj->m_videoCodecCtx && (obj->m_playControl.bPause || obj->m_bReverse) &&
+			(obj->m_presentItemCount > 0 || !obj->m_bReviewable))
+		{
+			obj->m_playControl.stateEvent.wait([obj] {
+				return !(obj->m_playControl.bPause || obj->m_bReverse) || obj->m_playControl.bAbort;
+			}, obj->EVENT_WAIT_MS);
+			continue;
+		}
+		if (obj->m_videoCodecCtx && (obj->m_playControl.bPause || obj->m_bReverse))
+		{
+			if (!obj->m_bInReview)
+			{
+				obj->m_bInReview = true;
+				obj->m_reviewSerial = serial;
+			}
+			obj->refreshReview();
+			continue;
+		}
+		obj->m_bInReview = false;
+		if (obj->m_bLive)
+		{
+			obj->updateLiveLatency();
+		}
+		obj->updatePlayControlState();
+		if (obj->m_playControl.bPlayEof)
+		{
+			// ɺ˳seek
+			if (!bFinished)
+			{
+				bFinished = true;
+				emit obj->playFinished();
+			}
+			obj->m_playControl.stateEvent.wait([obj, serial] {
+				return obj->m_playControl.seekSerial != serial || obj->m_playControl.bAbort;
+			}, obj->EVENT_WAIT_MS);
+			continue;
+		}
+		if (obj->m_videoCodecCtx && !obj->m_playControl.bPlayVideoEof)
+		{
+			obj->refreshVideo(); // ֡ʱ֡ϵȴ
+		}
+		else
+		{
+			// ûƵˢ£ȴƵ
+			obj->m_playControl.stateEvent.wait([obj, serial] {
+				return obj->m_playControl.bPlayAudioEof || obj->m_playControl.seekSerial != serial ||
+					obj->m_playControl.bAbort;
+			}, obj->EVENT_WAIT_MS);
+		}
+	}
+	return 0;
+}
+
+bool Decoder::isLiveUrl(const std::string& url)
+{
+	static const std::string LIVE_SCHEMES[] = { "rtsp://", "rtsps://", "rtmp://", "rtmps://", "udp://", "rtp://", "srt://" };
+	for (const std::string& scheme : LIVE_SCHEMES)
+	{
+		if (url.compare(0, scheme.size(), scheme) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void Decoder::updateLiveLatency()
+{
+	int64_t now = av_gettime_relative();
+	if (now - m_liveLastCheck < LIVE_CHECK_INTERVAL)
+	{
+		return;
+	}
+	m_liveLastCheck = now;
+	int64_t readPts = m_liveReadPts;
+	int64_t master = masterClock(now);
+	if (readPts == AV_NOPTS_VALUE || master == AV_NOPTS_VALUE)
+	{
+		return;
+	}
+	int64_t latency = FFMAX(readPts - master, 0);
+	int64_t target = (int64_t)m_liveTargetLatency * 1000;
+	m_liveLatency = latency;
+	bool bResumed = m_bLiveResumed.exchange(false);
+	if ((bResumed && latency > target + LIVE_SPEED_UP_MARGIN) ||
+		(latency > target + LIVE_DROP_MARGIN && now - m_liveCatchUpTime > LIVE_SETTLE_TIME))
+	{
+		// ѹ̶̫࣬߳ѽδŵݣ֮֡뵽Ŀӳٴ
+		m_liveCatchUpTarget = readPts - target;
+		m_liveCatchUpSerial++;
+		m_audioRing.interrupt(); // ƵдĻζ
+		m_liveCatchUpTime = now;
+		m_liveCatchUps++;
+		return;
+	}
+	// ԳĿʱС٣صĿڻָûĹٶʱԤ
+	float speed = m_playControl.speed;
+	if (!m_bLiveSpeedUp && speed == 1.0f && latency > target + LIVE_SPEED_UP_MARGIN)
+	{
+		applyPlaybackSpeed(LIVE_SPEED_UP);
+		m_bLiveSpeedUp = true;
+	}
+	else if (m_bLiveSpeedUp && speed != LIVE_SPEED_UP)
+	{
+		m_bLiveSpeedUp = false;
+	}
+	else if (m_bLiveSpeedUp && latency <= target)
+	{
+		applyPlaybackSpeed(1.0f);
+		m_bLiveSpeedUp = false;
+	}
+}
+
+int Decoder::abortInterruptCallback(void* data)
+{
+	Decoder* obj = static_cast<Decoder*>(data);
+	return obj->m_playControl.bAbort;
+}
+
+int Decoder::readThread(void* data)
+{
+	Decoder* obj = static_cast<Decoder*>(data);
+	while (obj->readStep(true) != DecodeScheduler::TaskState::DONE)
+	{
+	}
+	return 0;
+}
+
+int Decoder::audioDecodeThread(void* data)
+{
+	Decoder* obj = static_cast<Decoder*>(data);
+	while (obj->audioDecodeStep(true) != DecodeScheduler::TaskState::DONE)
+	{
+	}
+	return 0;
+}
+
+int Decoder::videoDecodeThread(void* data)
+{
+	Decoder* obj = static_cast<Decoder*>(data);
+	while (obj->videoDecodeStep(true) != DecodeScheduler::TaskState::DONE)
+	{
+	}
+	return 0;
+}
+
+int Decoder::prerollThread(void* data)
+{
+	Decoder* obj = static_cast<Decoder*>(data);
+	obj->m_prerollItem = obj->openPlaylistItem(obj->m_prerollUrl, obj->m_prerollIndex);
+	SDL_SemPost(obj->m_prerollDone);
+	return 0;
+}
+
+void Decoder::normalizePacket(AVFormatContext* fmtCtx, AVPacket* pkt)
+{
+	// ͳһ㵽AV_TIME_BASE߳ٻ㵽time_base
+	av_packet_rescale_ts(pkt, fmtCtx->streams[pkt->stream_index]->time_base, { 1, AV_TIME_BASE });
+	if (pkt->pts != AV_NOPTS_VALUE)
+	{
+		pkt->pts += m_playlistOffset;
+	}
+	if (pkt->dts != AV_NOPTS_VALUE)
+	{
+		pkt->dts += m_playlistOffset;
+	}
+	pkt->stream_index += m_playlistStreamBase;
+	if (pkt->pts == AV_NOPTS_VALUE)
+	{
+		return;
+	}
+	// ƵʱƵĽʱ̽һڻζβ
+	if (m_pReadPendingQue == &m_audioPktQue || m_nAudioInx < 0)
+	{
+		int64_t end = pkt->pts + pkt->duration;
+		m_playlistReadEnd = m_playlistReadEnd == AV_NOPTS_VALUE ? end : FFMAX(m_playlistReadEnd, end);
+	}
+	// 뱾prerollʱʼԤһ
+	if (!m_bPrerolling && m_playlistItemEnd != AV_NOPTS_VALUE && pkt->pts >= m_playlistItemEnd - (int64_t)m_preroll * 1000)
+	{
+		startPreroll();
+	}
+}
+
+bool Decoder::startPreroll()
+{
+	// ̣߳closeStreamȡm_prerollThreadʱ©ڴ߳
+	SDL_LockMutex(m_playlistMutex);
+	int next = m_playlistReadIndex + 1;
+	bool bNext = next < m_playlist.size() && !m_playControl.bAbort;
+	if (bNext)
+	{
+		m_prerollIndex = next;
+		m_prerollUrl = m_playlist[next].toStdString();
+		m_prerollItem = nullptr;
+		m_prerollThread = SDL_CreateThread(prerollThread, "preroll", this);
+		m_bPrerolling = true;
+	}
+	SDL_UnlockMutex(m_playlistMutex);
+	return bNext;
+}
+
+bool Decoder::playlistAdvance()
+{
+	while (!m_playControl.bAbort)
+	{
+		// ʱδ֪̫ʱûʼԤ򿪣ͬȴ
+		if (!m_bPrerolling && !startPreroll())
+		{
+			return false;
+		}
+		finishPreroll();
+		if (m_playControl.bAbort)
+		{
+			return false; // closeStreamͷm_prerollItem
+		}
+		m_bPrerolling = false;
+		PlaylistItem* item = m_prerollItem;
+		m_prerollItem = nullptr;
+		if (!item)
+		{
+			// ʧܣһ
+			m_playlistReadIndex = m_prerollIndex;
+			continue;
+		}
+
+		// һʱѶһ֮
+		int64_t base = m_playlistReadEnd != AV_NOPTS_VALUE ? m_playlistReadEnd : m_playlistItemBase.load();
+		installPlaylistItem(item, base);
+		SDL_LockMutex(m_playlistMutex);
+		m_playlistBoundaries.push_back(std::make_pair(base, item->index));
+		m_playlistBoundaryCount = (int)m_playlistBoundaries.size();
+		SDL_UnlockMutex(m_playlistMutex);
+		delete item;
+		return true;
+	}
+	return false;
+}
+
+void Decoder::finishPreroll()
+{
+	SDL_SemWait(m_prerollDone);
+	SDL_LockMutex(m_playlistMutex);
+	SDL_Thread* preroll = m_prerollThread;
+	m_prerollThread = nullptr;
+	SDL_UnlockMutex(m_playlistMutex);
+	SDL_WaitThread(preroll, NULL);
+}
+
+bool Decoder::reopenPlaylistItem(int index, int64_t base)
+{
+	// Ԥ򿪵ڶȡһҪ
+	if (m_bPrerolling)
+	{
+		finishPreroll();
+		if (m_playControl.bAbort)
+		{
+			return false; // closeStreamͷm_prerollItem
+		}
+		m_bPrerolling = false;
+		freePlaylistItem(m_prerollItem);
+		m_prerollItem = nullptr;
+	}
+	SDL_LockMutex(m_playlistMutex);
+	bool bValid = index >= 0 && index < m_playlist.size();
+	std::string url = bValid ? m_playlist[index].toStdString() : std::string();
+	SDL_UnlockMutex(m_playlistMutex);
+	PlaylistItem* item = bValid ? openPlaylistItem(url, index) : nullptr;
+	if (!item)
+	{
+		return false;
+	}
+	installPlaylistItem(item, base);
+	delete item;
+	return true;
+}
+
+void Decoder::installPlaylistItem(PlaylistItem* item, int64_t base)
+{
+	int64_t startTime = item->fmtCtx->start_time != AV_NOPTS_VALUE ? item->fmtCtx->start_time : 0;
+	if (m_playlistCtx)
+	{
+		avformat_close_input(&m_playlistCtx);
+	}
+	m_playlistCtx = item->fmtCtx;
+	m_playlistOffset = base - startTime;
+	m_playlistStreamBase += PLAYLIST_STREAM_STRIDE;
+	m_playlistItemBase = base;
+	m_playlistItemEnd = m_playlistCtx->duration != AV_NOPTS_VALUE ? base + m_playlistCtx->duration : AV_NOPTS_VALUE;
+	m_playlistReadEnd = AV_NOPTS_VALUE;
+	m_playlistReadIndex = item->index;
+	m_nAudioInx = item->audioCtx ? item->audioIndex : -1;
+	m_nVideoInx = item->videoCtx ? item->videoIndex : -1;
+	// ߳ȡһĵһʱ׼Ľ
+	if (item->audioCtx)
+	{
+		m_preparedAudioCodecs.push(m_nAudioInx + m_playlistStreamBase, item->audioCtx);
+	}
+	if (item->videoCtx)
+	{
+		m_preparedVideoCodecs.push(m_nVideoInx + m_playlistStreamBase, item->videoCtx);
+	}
+}
+
+Decoder::PlaylistItem* Decoder::openPlaylistItem(const std::string& url, int index)
+{
+	PlaylistItem* item = new PlaylistItem;
+	item->index = index;
+	item->fmtCtx = avformat_alloc_context();
+	item->fmtCtx->interrupt_callback.callback = abortInterruptCallback;
+	item->fmtCtx->interrupt_callback.opaque = this;
+	int ret = avformat_open_input(&item->fmtCtx, url.c_str(), nullptr, nullptr);
+	if (ret < 0)
+	{
+		outputError("avformat_open_input", ret);
+		delete item;
+		return nullptr;
+	}
+	ProbeCache probeCache;
+	bool bProbeCache = m_bProbeCache && MmapIO::isLocalPath(url) &&
+		probeCache.open(url, QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString() + "/probe");
+	if (!bProbeCache || !probeCache.load(item->fmtCtx))
+	{
+		ret = avformat_find_stream_info(item->fmtCtx, nullptr);
+		if (ret < 0)
 		{
-			obj->outputError("av_read_frame", ret);
-			break;
+			outputError("avformat_find_stream_info", ret);
+			freePlaylistItem(item);
+			return nullptr;
 		}
-		if (obj->m_pRreadPkt->stream_index == obj->m_nAudioInx)
+		if (bProbeCache)
 		{
-			// 
-			if (obj->m_audioCodecCtx)
-			{
-				obj->m_audioPktQue.push(obj->m_pRreadPkt);
-			}
+			probeCache.store(item->fmtCtx);
+		}
+	}
+	for (unsigned int i = 0; i < item->fmtCtx->nb_streams; ++i)
+	{
+		AVMediaType type = item->fmtCtx->streams[i]->codecpar->codec_type;
+		if (type == AVMEDIA_TYPE_AUDIO)
+		{
+			item->audioIndex = i;
+		}
+		if (type == AVMEDIA_TYPE_VIDEO)
+		{
+			item->videoIndex = i;
 		}
-		else if (obj->m_pRreadPkt->stream_index == obj->m_nVideoInx)
+	}
+	// ֻеǰн̵߳ܽϣ
+	if (item->audioIndex >= 0 && m_audioCodecCtx)
+	{
+		item->audioCtx = openSwitchCodec(item->fmtCtx->streams[item->audioIndex], m_audioCodecCtx);
+	}
+	if (item->videoIndex >= 0 && m_videoCodecCtx)
+	{
+		item->videoCtx = openSwitchCodec(item->fmtCtx->streams[item->videoIndex], m_videoCodecCtx);
+	}
+	if (!item->audioCtx && !item->videoCtx)
+	{
+		std::cout << "[playlist]: no playable stream in item " << index << std::endl;
+		freePlaylistItem(item);
+		return nullptr;
+	}
+	return item;
+}
+
+void Decoder::freePlaylistItem(PlaylistItem* item)
+{
+	if (!item)
+	{
+		return;
+	}
+	avcodec_free_context(&item->audioCtx);
+	avcodec_free_context(&item->videoCtx);
+	avformat_close_input(&item->fmtCtx);
+	delete item;
+}
+
+void Decoder::updatePlaylistIndex()
+{
+	int64_t clock = masterClock(av_gettime_relative());
+	if (clock == AV_NOPTS_VALUE)
+	{
+		return;
+	}
+	int index = -1;
+	SDL_LockMutex(m_playlistMutex);
+	while (!m_playlistBoundaries.empty() && m_playlistBoundaries.front().first <= clock)
+	{
+		index = m_playlistBoundaries.front().second;
+		m_playlistPresentBase = m_playlistBoundaries.front().first;
+		m_playlistBoundaries.pop_front();
+		m_presentItemCount++;
+	}
+	m_playlistBoundaryCount = (int)m_playlistBoundaries.size();
+	// һڸ£seekȡ±ͬһ
+	if (index >= 0)
+	{
+		m_playlistIndex = index;
+	}
+	SDL_UnlockMutex(m_playlistMutex);
+	if (index >= 0)
+	{
+		emit playlistIndexChanged();
+	}
+}
+
+int Decoder::abrIoOpen(AVFormatContext* s, AVIOContext** pb, const char* url, int flags, AVDictionary** options)
+{
+	Decoder* obj = static_cast<Decoder*>(s->opaque);
+	int ret = obj->m_defaultIoOpen(s, pb, url, flags, options);
+	// бˢ²Ƭ
+	if (ret >= 0 && !strstr(url, ".m3u8"))
+	{
+		obj->m_abr.segmentOpened(*pb, obj->ioBusyClock());
+	}
+	return ret;
+}
+
+void Decoder::abrIoClose(AVFormatContext* s, AVIOContext* pb)
+{
+	Decoder* obj = static_cast<Decoder*>(s->opaque);
+	if (pb)
+	{
+		obj->m_abr.segmentClosed(pb, pb->bytes_read, obj->ioBusyClock());
+	}
+	obj->m_defaultIoClose(s, pb);
+}
+
+int64_t Decoder::ioBusyClock()
+{
+	return m_ioBusyTime + (m_ioBusyStart ? av_gettime_relative() - m_ioBusyStart : 0);
+}
+
+bool Decoder::abrFilterPacket(AVPacket* pkt)
+{
+	int64_t now = av_gettime_relative();
+	if (m_abrSwitching >= 0)
+	{
+		// variantƵӹؼ֡ʼ棬Ƶһͽ棬֮İ
+		const AbrController::Variant& next = m_abr.variant(m_abrSwitching);
+		if (pkt->stream_index == next.videoIndex && m_nVideoInx != next.videoIndex)
 		{
-			// Ƶ
-			if (obj->m_videoCodecCtx)
+			if (!(pkt->flags & AV_PKT_FLAG_KEY))
 			{
-				obj->m_videoPktQue.push(obj->m_pRreadPkt);
+				return false;
 			}
+			m_nVideoInx = next.videoIndex;
+		}
+		else if (pkt->stream_index == next.audioIndex && m_nAudioInx != next.audioIndex)
+		{
+			m_nAudioInx = next.audioIndex;
+		}
+		if (m_nVideoInx == next.videoIndex && (next.audioIndex < 0 || !m_audioCodecCtx || m_nAudioInx == next.audioIndex))
+		{
+			m_abr.applyDiscard(m_fmtCtx, m_abrSwitching, -1);
+			m_abr.setCurrent(m_abrSwitching, now);
+			m_abrSwitching = -1;
+		}
+	}
+	if (pkt->stream_index == m_nVideoInx && pkt->pts != AV_NOPTS_VALUE)
+	{
+		AVRational tb = m_fmtCtx->streams[m_nVideoInx]->time_base;
+		m_abrReadPts = av_rescale_q(pkt->pts, tb, { 1, AV_TIME_BASE });
+		m_abr.addMedia(av_rescale_q(pkt->duration, tb, { 1, AV_TIME_BASE }));
+	}
+	if (m_abrSwitching < 0 && now - m_abrLastCheck >= ABR_CHECK_INTERVAL)
+	{
+		m_abrLastCheck = now;
+		// λȡƵʱӣһ֡ʾ֮ǰseek֮ûУ޻崦
+		int64_t playing = m_videoClock.get(now);
+		int64_t bufferLevel = m_abrReadPts == AV_NOPTS_VALUE || playing == AV_NOPTS_VALUE ? 0 : FFMAX(m_abrReadPts - playing, 0);
+		int target = m_abr.select(bufferLevel, now);
+		if (target != m_abr.current())
+		{
+			abrStartSwitch(target);
 		}
-		av_packet_unref(obj->m_pRreadPkt);
 	}
+	return pkt->stream_index == m_nVideoInx || pkt->stream_index == m_nAudioInx;
+}
+
+void Decoder::abrStartSwitch(int target)
+{
+	const AbrController::Variant& next = m_abr.variant(target);
+	// ͬȴ򿪽̻߳ʱֱӻ
+	if (m_videoCodecCtx)
+	{
+		prepareSwitchCodec(m_videoCodecCtx, next.videoIndex, m_preparedVideoCodecs);
+	}
+	if (m_audioCodecCtx && next.audioIndex >= 0 && next.audioIndex != m_nAudioInx)
+	{
+		prepareSwitchCodec(m_audioCodecCtx, next.audioIndex, m_preparedAudioCodecs);
+	}
+	// İ֮ǰvariantأŲж
+	m_abr.applyDiscard(m_fmtCtx, m_abr.current(), target);
+	m_abrSwitching = target;
+}
+
+bool Decoder::isCodecCompatible(AVCodecContext* codecCtx, AVCodecParameters* par)
+{
+	if (codecCtx->codec_id != par->codec_id || codecCtx->extradata_size != par->extradata_size ||
+		(par->extradata_size > 0 && memcmp(codecCtx->extradata, par->extradata, par->extradata_size) != 0))
+	{
+		return false;
+	}
+	// Ƶֱʱ仯ɽдƵʽ仯Ҫؽز
+	return par->codec_type != AVMEDIA_TYPE_AUDIO ||
+		(codecCtx->sample_rate == par->sample_rate && codecCtx->channels == par->channels);
+}
 
-	if (obj->m_audioCodecCtx)
+AVCodecContext* Decoder::openSwitchCodec(AVStream* stream, AVCodecContext* like)
+{
+	AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+	AVCodecContext* codecCtx = codec ? avcodec_alloc_context3(codec) : nullptr;
+	if (!codecCtx)
 	{
-		obj->m_audioPktQue.push(nullptr);
+		return nullptr;
 	}
-	if (obj->m_videoCodecCtx)
+	avcodec_parameters_to_context(codecCtx, stream->codecpar);
+	codecCtx->pkt_timebase = stream->time_base;
+	if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
 	{
-		obj->m_videoPktQue.push(nullptr);
+		applyDecodeThreadConfig(codecCtx);
+		codecCtx->skip_loop_filter = like->skip_loop_filter;
+		codecCtx->skip_frame = like->skip_frame;
 	}
-	obj->m_playControl.bReadEof = true;
-	return 0;
+	if (avcodec_open2(codecCtx, codec, nullptr) < 0)
+	{
+		avcodec_free_context(&codecCtx);
+		return nullptr;
+	}
+	// е֡ɽtime_baseptsһ
+	codecCtx->time_base = like->time_base;
+	return codecCtx;
 }
 
-bool Decoder::isAudioCacheOverLoad()
+void Decoder::prepareSwitchCodec(AVCodecContext* codecCtx, int streamIndex, PreparedCodecQueue& prepared)
 {
-	return m_audioFrameQue.totalDataByte >= m_audioCacheMaxByte;
+	if (isCodecCompatible(codecCtx, m_fmtCtx->streams[streamIndex]->codecpar))
+	{
+		return;
+	}
+	AVCodecContext* newCtx = openSwitchCodec(m_fmtCtx->streams[streamIndex], codecCtx);
+	if (!newCtx)
+	{
+		return;
+	}
+	prepared.push(streamIndex, newCtx);
 }
 
-int Decoder::audioDecodeThread(void* data)
+bool Decoder::switchDecoder(AVCodecContext** codecCtx, int streamIndex, PreparedCodecQueue& prepared,
+	std::vector<AVCodecContext*>& retired)
 {
-	Decoder* obj = static_cast<Decoder*>(data);
-	int recRet = 0;
-	while (!obj->m_playControl.bAbort && recRet != AVERROR(EOF) && recRet != AVERROR_EOF)
+	AVCodecContext* newCtx = prepared.take(streamIndex);
+	// б֮m_fmtCtxУÿĽɶȡ̰߳Ĳ׼ãһ
+	if (!newCtx && streamIndex >= PLAYLIST_STREAM_STRIDE)
+	{
+		std::cout << "no prepared decoder for stream " << streamIndex << std::endl;
+		avcodec_flush_buffers(*codecCtx);
+		return false;
+	}
+	// ͬһļвͬлþɽ
+	if (!newCtx && isCodecCompatible(*codecCtx, m_fmtCtx->streams[streamIndex]->codecpar))
+	{
+		avcodec_flush_buffers(*codecCtx);
+		return false;
+	}
+	// ȡ߳ûü׼ʱ򿪣ʧþɽ
+	if (!newCtx)
 	{
-		// жǷ
-		if (obj->isAudioCacheOverLoad())
+		newCtx = openSwitchCodec(m_fmtCtx->streams[streamIndex], *codecCtx);
+	}
+	if (!newCtx)
+	{
+		avcodec_flush_buffers(*codecCtx);
+		return false;
+	}
+	retired.push_back(*codecCtx);
+	*codecCtx = newCtx;
+	return true;
+}
+
+DecodeScheduler::TaskState Decoder::readStep(bool bBlock)
+{
+	if (m_playControl.bAbort)
+	{
+		m_playControl.bReadEof = true;
+		return DecodeScheduler::TaskState::DONE;
+	}
+	if (m_playControl.seekSerial != m_readSerial)
+	{
+		// δдİеľɰɽ뻷ڰserial
+		int64_t target = 0;
+		bool bAccurate = true;
+		int seekItem = 0;
+		int64_t seekItemBase = 0;
+		int serial = m_playControl.currentSeek(&target, &bAccurate, &seekItem, &seekItemBase);
+		if (m_pReadPendingQue)
 		{
-			continue;
+			av_packet_unref(m_pRreadPkt);
+			m_pReadPendingQue = nullptr;
+		}
+		// Ѷʱ´ڲŵʱ
+		if (seekItem != m_playlistReadIndex && !reopenPlaylistItem(seekItem, seekItemBase))
+		{
+			std::cout << "[playlist]: failed to reopen item " << seekItem << " for seek" << std::endl;
+		}
+		// λöı߽Ͷȡʱ̶Ч
+		SDL_LockMutex(m_playlistMutex);
+		m_playlistBoundaries.clear();
+		m_playlistBoundaryCount = 0;
+		SDL_UnlockMutex(m_playlistMutex);
+		m_playlistReadEnd = AV_NOPTS_VALUE;
+		// ʱֱĿ֮ǰؼֽ֡ƫƣʧٰʱseekֻԵһ
+		int ret = -1;
+		KeyframeIndex::Entry keyframe;
+		if (!m_playlistCtx && m_keyframeIndex.find(target, &keyframe))
+		{
+			ret = av_seek_frame(m_fmtCtx, -1, keyframe.pos, AVSEEK_FLAG_BYTE);
+		}
+		// seekȡĹؼ֡ȷseekȡĿ֮ǰĹؼ֡Ŀȥƫ
+		if (ret < 0)
+		{
+			int64_t itemTarget = target - m_playlistOffset;
+			ret = avformat_seek_file(readFormatContext(), -1, INT64_MIN, itemTarget, bAccurate ? itemTarget : INT64_MAX, 0);
+		}
+		if (ret < 0)
+		{
+			outputError("avformat_seek_file", ret);
+		}
+		m_bReadEnd = false;
+		m_readEndQueued = 0;
+		m_playControl.bReadEof = false;
+		m_liveReadPts = AV_NOPTS_VALUE;
+		m_abrReadPts = AV_NOPTS_VALUE;
+		m_readSerial = serial;
+	}
+	if (m_playControl.bReadEof)
+	{
+		// ȡɣȴseekر
+		if (bBlock)
+		{
+			m_playControl.stateEvent.wait([this] {
+				return m_playControl.seekSerial != m_readSerial || m_playControl.bAbort;
+			}, EVENT_WAIT_MS);
+		}
+		return DecodeScheduler::TaskState::IDLE;
+	}
+	if (!m_pReadPendingQue && !m_bReadEnd)
+	{
+		m_ioBusyStart = av_gettime_relative();
+		AVFormatContext* fmtCtx = readFormatContext();
+		int ret = m_playControl.bAbort ? AVERROR_EXIT : av_read_frame(fmtCtx, m_pRreadPkt);
+		int64_t readTime = av_gettime_relative() - m_ioBusyStart;
+		m_ioBusyStart = 0;
+		m_ioBusyTime += readTime;
+		m_demuxTime += readTime;
+		if (ret >= 0)
+		{
+			m_demuxPackets++;
+			m_demuxBytes += m_pRreadPkt->size;
+		}
+		if (ret == AVERROR_EOF && playlistAdvance())
+		{
+			return DecodeScheduler::TaskState::BUSY; // Ŷһд
+		}
+		if (ret < 0)
+		{
+			if (ret != AVERROR_EXIT)
+			{
+				outputError("av_read_frame", ret);
+			}
+			m_bReadEnd = true;
+		}
+		else if (!m_playlistCtx && m_abr.isEnabled() && !abrFilterPacket(m_pRreadPkt))
+		{
+			av_packet_unref(m_pRreadPkt);
+		}
+		else if (m_pRreadPkt->stream_index == m_nAudioInx && m_audioCodecCtx)
+		{
+			m_pReadPendingQue = &m_audioPktQue; // 
 		}
-		// ȡ껺
-		while (1)
+		else if (m_pRreadPkt->stream_index == m_nVideoInx && m_videoCodecCtx)
 		{
-			recRet = avcodec_receive_frame(obj->m_audioCodecCtx, obj->m_pAudioFrame);
-			if (recRet != 0)
+			m_pReadPendingQue = &m_videoPktQue; // Ƶ
+		}
+		else
+		{
+			av_packet_unref(m_pRreadPkt);
+		}
+		if (m_pReadPendingQue)
+		{
+			normalizePacket(fmtCtx, m_pRreadPkt);
+		}
+		if (m_bLive && m_pReadPendingQue)
+		{
+			// Ѷʱ̣ȥʱӼն˻ӳ
+			int64_t ts = m_pRreadPkt->pts != AV_NOPTS_VALUE ? m_pRreadPkt->pts : m_pRreadPkt->dts;
+			if (ts != AV_NOPTS_VALUE)
 			{
-				break;
+				int64_t last = m_liveReadPts;
+				m_liveReadPts = last == AV_NOPTS_VALUE ? ts : FFMAX(last, ts);
+			}
+		}
+	}
+	if (m_pReadPendingQue)
+	{
+		if (!m_pReadPendingQue->offer(m_pRreadPkt, bBlock, m_readSerial))
+		{
+			return DecodeScheduler::TaskState::IDLE;
+		}
+		av_packet_unref(m_pRreadPkt);
+		m_pReadPendingQue = nullptr;
+	}
+	if (m_bReadEnd)
+	{
+		PacketQueue* endQues[] = {
+			m_audioCodecCtx ? &m_audioPktQue : nullptr,
+			m_videoCodecCtx ? &m_videoPktQue : nullptr,
+		};
+		for (; m_readEndQueued < 2; ++m_readEndQueued)
+		{
+			PacketQueue* que = endQues[m_readEndQueued];
+			if (que && !que->offer(nullptr, bBlock, m_readSerial))
+			{
+				return DecodeScheduler::TaskState::IDLE;
 			}
-			memset(obj->m_audioBuff, 0, obj->m_audioBufferTotalSize);
-			int len = swr_convert(
-				obj->m_swrCtx,
-				(uint8_t**)&obj->m_audioBuff,
-				obj->m_audioBufferTotalSize,
-				(const uint8_t**)obj->m_pAudioFrame->data,
-				obj->m_pAudioFrame->nb_samples);
-			int audioBufferSize = len * obj->m_nChannelFormatByte;
-			AudioData* audioData = new AudioData(obj->m_audioBuff,
-				audioBufferSize,
-				obj->m_pAudioFrame->pts);
-			obj->m_audioFrameQue.push(audioData);
+		}
+		m_playControl.bReadEof = true;
+		return DecodeScheduler::TaskState::IDLE;
+	}
+	return DecodeScheduler::TaskState::BUSY;
+}
+
+DecodeScheduler::TaskState Decoder::audioDecodeStep(bool bBlock)
+{
+	if (m_playControl.bAbort)
+	{
+		m_playControl.bAudioDecodeEof = true;
 #ifdef SAVEPCM
-			fwrite(obj->m_audioBuff, audioBufferSize, 1, g_pcmFp);
+		fclose(g_pcmFp);
 #endif
-		}
-		// Ҫ
-		if (recRet == AVERROR(EAGAIN))
+		return DecodeScheduler::TaskState::DONE;
+	}
+	if (m_playControl.seekSerial != m_audioSerial)
+	{
+		// ˾ͻζеľݣеľɰfeedʱ
+		int64_t target = 0;
+		bool bAccurate = true;
+		int serial = m_playControl.currentSeek(&target, &bAccurate);
+		avcodec_flush_buffers(m_audioCodecCtx);
+		m_audioRing.flush();
+		m_audioTempo.close();
+		m_audioTempoSpeed = 1.0f;
+		m_audioRecRet = 0;
+		m_bAudioFramePending = false;
+		m_audioDropUntil = bAccurate ? target : AV_NOPTS_VALUE;
+		m_audioLastEnd = AV_NOPTS_VALUE;
+		m_playControl.bAudioDecodeEof = false;
+		m_audioSerial = serial;
+	}
+	if (m_liveCatchUpSerial != m_audioCatchUpSerial)
+	{
+		// ֱ׷ϣζδŵݣеĲο״̬
+		m_audioCatchUpSerial = m_liveCatchUpSerial;
+		m_audioRing.flush();
+		m_audioTempo.close();
+		m_audioTempoSpeed = 1.0f;
+		m_bAudioFramePending = false;
+		m_audioDropUntil = m_liveCatchUpTarget;
+	}
+	if (m_audioBatch.switchTo >= 0 && (m_audioRecRet == AVERROR(EOF) || m_audioRecRet == AVERROR_EOF))
+	{
+		// л򲥷б֡ȡ
+		// лʱд벿ص֡ʱȡ߳Ѱʱϣȫ
+		bool bNextItem = m_audioBatch.switchTo / PLAYLIST_STREAM_STRIDE != m_audioBatch.streamIndex / PLAYLIST_STREAM_STRIDE;
+		AVCodecContext* oldCtx = m_audioCodecCtx;
+		if (switchDecoder(&m_audioCodecCtx, m_audioBatch.switchTo, m_preparedAudioCodecs, m_retiredAudioCtx) &&
+			(oldCtx->sample_rate != m_audioCodecCtx->sample_rate || oldCtx->sample_fmt != m_audioCodecCtx->sample_fmt ||
+			oldCtx->channel_layout != m_audioCodecCtx->channel_layout || oldCtx->channels != m_audioCodecCtx->channels))
 		{
-			AVPacket* pkt = av_packet_alloc();
-			QueueState ret = obj->m_audioPktQue.pop(pkt);
-			if (ret == QueueState::NORMAL)
+			// ʽʱزȡлٰؽ豸ʽ
+			int outSamples = swr_get_out_samples(m_swrCtx, 0);
+			if (outSamples > 0)
 			{
-				av_packet_rescale_ts(pkt, obj->m_fmtCtx->streams[obj->m_nAudioInx]->time_base, obj->m_audioCodecCtx->time_base);
-				avcodec_send_packet(obj->m_audioCodecCtx, pkt);
+				av_fast_malloc(&m_audioConvertBuf, &m_audioConvertBufSize, outSamples * m_nChannelFormatByte);
+				int len = swr_convert(m_swrCtx, &m_audioConvertBuf, outSamples, nullptr, 0);
+				size_t bytes = FFMAX(len, 0) * m_nChannelFormatByte;
+				if (bytes > 0 && m_audioRing.writable(bytes))
+				{
+					m_audioRing.write(m_audioConvertBuf, bytes, AV_NOPTS_VALUE);
+				}
 			}
-			else if (ret == QueueState::LAST)
+			m_swrCtx = swr_alloc_set_opts(m_swrCtx,
+				m_pAudioCodecParam->channel_layout, (AVSampleFormat)m_audioFormatPreset[0], m_settingSpec.freq,
+				m_audioCodecCtx->channel_layout ? m_audioCodecCtx->channel_layout : av_get_default_channel_layout(m_audioCodecCtx->channels),
+				m_audioCodecCtx->sample_fmt, m_audioCodecCtx->sample_rate,
+				-1, nullptr);
+			swr_init(m_swrCtx);
+		}
+		m_audioBatch.streamIndex = m_audioBatch.switchTo;
+		m_audioBatch.switchTo = -1;
+		m_audioRecRet = 0;
+		// ʱȷseekĶĿ꣬seek´򿪵ҲĿ꿪ʼ
+		if (!bNextItem && m_audioLastEnd != AV_NOPTS_VALUE)
+		{
+			m_audioDropUntil = m_audioLastEnd;
+		}
+	}
+	// ϴûµıд
+	if (m_audioTempo.isActive() && !writeTempoOutput(bBlock))
+	{
+		return bBlock ? DecodeScheduler::TaskState::BUSY : DecodeScheduler::TaskState::IDLE;
+	}
+	if (m_audioRecRet == AVERROR(EOF) || m_audioRecRet == AVERROR_EOF)
+	{
+		// ˾лβҲд
+		if (m_audioTempo.isActive())
+		{
+			m_audioTempo.flush();
+			if (!writeTempoOutput(bBlock))
 			{
-				avcodec_send_packet(obj->m_audioCodecCtx, nullptr);
+				return bBlock ? DecodeScheduler::TaskState::BUSY : DecodeScheduler::TaskState::IDLE;
 			}
-			av_packet_free(&pkt);
 		}
+		// ɣȴseekر
+		m_playControl.bAudioDecodeEof = true;
+		if (bBlock)
+		{
+			m_playControl.stateEvent.wait([this] {
+				return m_playControl.seekSerial != m_audioSerial || m_playControl.bAbort;
+			}, EVENT_WAIT_MS);
+		}
+		return DecodeScheduler::TaskState::IDLE;
 	}
-	obj->m_playControl.bAudioDecodeEof = true;
+	// ȡ껺
+	while (1)
+	{
+		if (!m_bAudioFramePending)
+		{
+			m_audioRecRet = avcodec_receive_frame(m_audioCodecCtx, m_pAudioFrame);
+			if (m_audioRecRet != 0)
+			{
+				break;
+			}
+			// ȷseek֡Ŀ֮ǰֱӶ
+			if (m_audioDropUntil != AV_NOPTS_VALUE && m_pAudioFrame->pts != AV_NOPTS_VALUE)
+			{
+				int64_t endPts = av_rescale_q(m_pAudioFrame->pts, m_audioCodecCtx->time_base, { 1, AV_TIME_BASE }) +
+					(int64_t)m_pAudioFrame->nb_samples * AV_TIME_BASE / m_pAudioFrame->sample_rate;
+				if (endPts <= m_audioDropUntil)
+				{
+					continue;
+				}
+			}
+			m_audioDropUntil = AV_NOPTS_VALUE;
+			if (m_pAudioFrame->pts != AV_NOPTS_VALUE)
+			{
+				m_audioLastEnd = av_rescale_q(m_pAudioFrame->pts, m_audioCodecCtx->time_base, { 1, AV_TIME_BASE }) +
+					(int64_t)m_pAudioFrame->nb_samples * AV_TIME_BASE / m_pAudioFrame->sample_rate;
+			}
+			m_bAudioFramePending = true;
+		}
+		// ζʱȴ
+		int outSamples = swr_get_out_samples(m_swrCtx, m_pAudioFrame->nb_samples);
+		size_t maxBytes = outSamples * m_nChannelFormatByte;
+		float speed = m_playControl.speed;
+		if (speed != m_audioTempoSpeed)
+		{
+			// ˾лд뻷ζؽٴ϶
+			if (m_audioTempo.isActive())
+			{
+				m_audioTempo.flush();
+				if (!writeTempoOutput(bBlock))
+				{
+					return bBlock ? DecodeScheduler::TaskState::BUSY : DecodeScheduler::TaskState::IDLE;
+				}
+			}
+			m_audioTempoSpeed = speed;
+			if (speed == 1.0f)
+			{
+				m_audioTempo.close();
+			}
+			else
+			{
+				m_audioTempo.init(speed, m_settingSpec.freq, (AVSampleFormat)m_audioFormatPreset[0], m_settingSpec.channels);
+			}
+		}
+		// ٺԼΪٶȣ100msatempoܹһں
+		size_t needBytes = m_audioTempo.isActive() ? (size_t)(maxBytes / speed) + m_audioRing.bytesPerSec / 10 : maxBytes;
+		if (!bBlock && !m_audioRing.writable(needBytes))
+		{
+			return DecodeScheduler::TaskState::IDLE;
+		}
+		if (bBlock && !m_audioRing.waitWritable(needBytes))
+		{
+			return DecodeScheduler::TaskState::BUSY; // abortseekһ
+		}
+		m_bAudioFramePending = false;
+		int64_t pts = m_pAudioFrame->pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE :
+			av_rescale_q(m_pAudioFrame->pts, m_audioCodecCtx->time_base, { 1, AV_TIME_BASE });
+		// βռʱֱزζУתʱbuffer
+		size_t contiguous = 0;
+		uint8_t* outBuf = m_audioRing.writePtr(&contiguous);
+		bool bDirect = !m_audioTempo.isActive() && contiguous >= maxBytes;
+		if (!bDirect)
+		{
+			av_fast_malloc(&m_audioConvertBuf, &m_audioConvertBufSize, maxBytes);
+			outBuf = m_audioConvertBuf;
+		}
+		int len = swr_convert(
+			m_swrCtx,
+			&outBuf,
+			outSamples,
+			(const uint8_t**)m_pAudioFrame->data,
+			m_pAudioFrame->nb_samples);
+		size_t audioBufferSize = FFMAX(len, 0) * m_nChannelFormatByte;
+		if (m_audioTempo.isActive())
+		{
+			m_audioTempo.send(outBuf, FFMAX(len, 0), pts);
+			if (!writeTempoOutput(bBlock))
+			{
+				return bBlock ? DecodeScheduler::TaskState::BUSY : DecodeScheduler::TaskState::IDLE;
+			}
+		}
+		else if (bDirect)
+		{
+			m_audioRing.commit(audioBufferSize, pts);
+		}
+		else
+		{
+			m_audioRing.write(outBuf, audioBufferSize, pts);
+		}
 #ifdef SAVEPCM
-	fclose(g_pcmFp);
+		fwrite(outBuf, audioBufferSize, 1, g_pcmFp);
 #endif
-	return 0;
+	}
+	// Ҫ
+	if (m_audioRecRet == AVERROR(EAGAIN) &&
+		!m_audioBatch.feed(m_audioCodecCtx, m_audioPktQue, bBlock, m_audioSerial))
+	{
+		return DecodeScheduler::TaskState::IDLE;
+	}
+	return DecodeScheduler::TaskState::BUSY;
 }
 
-bool Decoder::isVideoCacheOverLoad()
+bool Decoder::writeTempoOutput(bool bBlock)
 {
-	return m_videoFrameQue.totalDataByte >= m_videoCacheMaxByte;
+	int64_t tempoPts = AV_NOPTS_VALUE;
+	while (AVFrame* tempoFrame = m_audioTempo.peek(&tempoPts))
+	{
+		size_t tempoBytes = (size_t)tempoFrame->nb_samples * m_nChannelFormatByte;
+		if (!m_audioRing.writable(tempoBytes) && (!bBlock || !m_audioRing.waitWritable(tempoBytes)))
+		{
+			return false;
+		}
+		m_audioRing.write(tempoFrame->data[0], FFMIN(tempoBytes, m_audioRing.capacity), tempoPts, (float)m_audioTempo.speed());
+		m_audioTempo.pop();
+	}
+	return true;
 }
 
-int Decoder::videoDecodeThread(void* data)
+DecodeScheduler::TaskState Decoder::videoDecodeStep(bool bBlock)
 {
-	Decoder* obj = static_cast<Decoder*>(data);
-	int recRet = 0;
-	while (!obj->m_playControl.bAbort && recRet != AVERROR(EOF) && recRet != AVERROR_EOF)
+	if (m_playControl.bAbort)
+	{
+		m_playControl.bVideoDecodeEof = true;
+		return DecodeScheduler::TaskState::DONE;
+	}
+	if (m_playControl.seekSerial != m_videoSerial)
 	{
-		// жǷ
-		if (obj->isVideoCacheOverLoad())
+		// ֡еľݣеľɰfeedʱ
+		int64_t target = 0;
+		bool bAccurate = true;
+		int serial = m_playControl.currentSeek(&target, &bAccurate);
+		avcodec_flush_buffers(m_videoCodecCtx);
+		m_videoFrameQue.clear();
+		m_videoRecRet = 0;
+		m_videoDropUntil = bAccurate ? target : AV_NOPTS_VALUE;
+		m_videoLastPts = AV_NOPTS_VALUE;
+		m_lateStreak = 0;
+		m_onTimeStreak = 0;
+		m_consecutiveDrops = 0;
+		// seek֮ǰĹز֮֡ص0
+		if (m_frameSkipLevel > 0)
 		{
-			continue;
+			m_frameSkipLevel = 0;
+			applyFrameSkipLevel();
+		}
+		m_playControl.bVideoDecodeEof = false;
+		m_videoSerial = serial;
+	}
+	if (m_liveCatchUpSerial != m_videoCatchUpSerial)
+	{
+		// ֱ׷ϣ֡Уճ뱣ֲο֡Ŀ֮ǰֻ벻
+		m_videoCatchUpSerial = m_liveCatchUpSerial;
+		m_videoFrameQue.clear();
+		m_videoDropUntil = m_liveCatchUpTarget;
+		m_bVideoDiscontinuity = true;
+	}
+	if (m_videoBatch.switchTo >= 0 && (m_videoRecRet == AVERROR(EOF) || m_videoRecRet == AVERROR_EOF))
+	{
+		// л֡ȡꣻӹؼ֡ʼھһֻ֡벻
+		// бʱһ֡ں棬
+		bool bNextItem = m_videoBatch.switchTo / PLAYLIST_STREAM_STRIDE != m_videoBatch.streamIndex / PLAYLIST_STREAM_STRIDE;
+		switchDecoder(&m_videoCodecCtx, m_videoBatch.switchTo, m_preparedVideoCodecs, m_retiredVideoCtx);
+		m_videoBatch.streamIndex = m_videoBatch.switchTo;
+		m_videoBatch.switchTo = -1;
+		m_videoRecRet = 0;
+		if (m_videoLastPts != AV_NOPTS_VALUE && !bNextItem)
+		{
+			m_videoDropUntil = m_videoLastPts + m_videoFrameDuration;
 		}
-		// ȡ
-		while (1)
+	}
+	if (m_videoRecRet == AVERROR(EOF) || m_videoRecRet == AVERROR_EOF)
+	{
+		// ɣȴseekر
+		m_playControl.bVideoDecodeEof = true;
+		if (bBlock)
 		{
-			recRet = avcodec_receive_frame(obj->m_videoCodecCtx, obj->m_pVideoFrame);
-			if (recRet != 0)
-			{
-				break;
-			}
-			sws_scale(
-				obj->m_swsCtx,
-				(const uint8_t* const*)obj->m_pVideoFrame->data, obj->m_pVideoFrame->linesize,
-				0, obj->m_pVideoCodecParam->height,
-				obj->m_pVideoOutFrame->data, obj->m_pVideoOutFrame->linesize);
-			VideoData *videoData = new VideoData(obj->m_pVideoOutBuffer, 
-				obj->m_videoOutBufferSize, 
-				obj->m_pVideoOutFrame->linesize[0],
-				obj->m_pVideoFrame->pts);
-			obj->m_videoFrameQue.push(videoData);
-			av_frame_unref(obj->m_pVideoFrame);
-		}
-		// Ҫ
-		if (recRet == AVERROR(EAGAIN))
-		{
-			AVPacket *pkt = av_packet_alloc();
-			QueueState ret = obj->m_videoPktQue.pop(pkt);
-			if (ret == QueueState::NORMAL)
+			m_playControl.stateEvent.wait([this] {
+				return m_playControl.seekSerial != m_videoSerial || m_playControl.bAbort;
+			}, EVENT_WAIT_MS);
+		}
+		return DecodeScheduler::TaskState::IDLE;
+	}
+	// ʱȴȾ
+	if (!bBlock && !m_videoFrameQue.isBelow(m_videoCacheMaxByte))
+	{
+		return DecodeScheduler::TaskState::IDLE;
+	}
+	if (bBlock)
+	{
+		m_videoFrameQue.waitBelow(m_videoCacheMaxByte);
+		if (m_playControl.bAbort)
+		{
+			return DecodeScheduler::TaskState::BUSY;
+		}
+	}
+	VideoData* frames[FRAME_BATCH_SIZE];
+	size_t frameCount = 0;
+	// ȡ
+	while (1)
+	{
+		m_videoRecRet = avcodec_receive_frame(m_videoCodecCtx, m_pVideoFrame);
+		if (m_videoRecRet != 0)
+		{
+			break;
+		}
+		// ȷseekĿ֮ǰֻ֡벻ת
+		if (m_videoDropUntil != AV_NOPTS_VALUE && m_pVideoFrame->pts != AV_NOPTS_VALUE)
+		{
+			int64_t pts = av_rescale_q(m_pVideoFrame->pts, m_videoCodecCtx->time_base, { 1, AV_TIME_BASE });
+			if (pts + m_videoFrameDuration <= m_videoDropUntil)
 			{
-				auto it1 = pkt->pts;
-				av_packet_rescale_ts(pkt, obj->m_fmtCtx->streams[obj->m_nVideoInx]->time_base, obj->m_videoCodecCtx->time_base);
-				auto it2 = pkt->pts;
-				avcodec_send_packet(obj->m_videoCodecCtx, pkt);
+				av_frame_unref(m_pVideoFrame);
+				continue;
 			}
-			else if (ret == QueueState::LAST)
+		}
+		m_videoDropUntil = AV_NOPTS_VALUE;
+		if (m_pVideoFrame->pts != AV_NOPTS_VALUE)
+		{
+			m_videoLastPts = av_rescale_q(m_pVideoFrame->pts, m_videoCodecCtx->time_base, { 1, AV_TIME_BASE });
+		}
+		// ѹڵ֡תҲ
+		AVFrame* outFrame = dropLateVideoFrame(m_pVideoFrame) ? nullptr : convertVideoFrame(m_pVideoFrame, &m_swsCtx);
+		if (outFrame)
+		{
+			frames[frameCount] = new VideoData(outFrame,
+				m_videoOutBufferSize,
+				m_pVideoFrame->pts,
+				m_videoSerial);
+			frames[frameCount++]->bDiscontinuity = m_bVideoDiscontinuity;
+			m_bVideoDiscontinuity = false;
+			if (frameCount == FRAME_BATCH_SIZE)
 			{
-				avcodec_send_packet(obj->m_videoCodecCtx, nullptr);
+				m_videoFrameQue.pushBatch(frames, frameCount);
+				frameCount = 0;
 			}
-			av_packet_free(&pkt);
 		}
+		av_frame_unref(m_pVideoFrame);
 	}
-	obj->m_playControl.bVideoDecodeEof = true;
-	return 0;
+	// ֽ֡һ
+	if (frameCount > 0)
+	{
+		m_videoFrameQue.pushBatch(frames, frameCount);
+	}
+	// Ҫ
+	if (m_videoRecRet == AVERROR(EAGAIN) &&
+		!m_videoBatch.feed(m_videoCodecCtx, m_videoPktQue, bBlock, m_videoSerial))
+	{
+		return DecodeScheduler::TaskState::IDLE;
+	}
+	return DecodeScheduler::TaskState::BUSY;
 }
 
 void Decoder::outputError(std::string&& funName, int ret)
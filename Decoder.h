@@ -2,7 +2,11 @@
 
 #include <string>
 #include <queue>
+#include <deque>
 #include <memory>
+#include <atomic>
+#include <vector>
+#include <algorithm>
 
 #include <QObject>
 #include <QAbstractVideoSurface>
@@ -10,6 +14,10 @@
 #include <QVideoSurfaceFormat>
 #include <QIODevice>
 #include <QAudioFormat>
+#include <QAudioOutput>
+#include <QVariantList>
+#include <QStringList>
+#include <QTimer>
 
 extern "C"
 {
@@ -25,14 +33,117 @@ extern "C"
 #include <SDL2/SDL_thread.h>
 }
 
+#include "FramePool.h"
+#include "AVFrameVideoBuffer.h"
+#include "DecodeScheduler.h"
+#include "PresentScheduler.h"
+#include "MediaClock.h"
+#include "AudioTempo.h"
+#include "KeyframeIndex.h"
+#include "GopCache.h"
+#include "MmapIO.h"
+#include "ReadAheadIO.h"
+#include "HttpCacheIO.h"
+#include "AbrController.h"
+#include "ProbeCache.h"
+#include "MediaQueue.h"
+
 
 class Decoder : public QIODevice
 {
 	Q_OBJECT
 	Q_PROPERTY(QAbstractVideoSurface* videoSurface READ videoSurface WRITE setVideoSurface)
 	Q_PROPERTY(QString videoUrl READ videoUrl WRITE setVideoUrl NOTIFY videoUrlChanged)
+	Q_PROPERTY(qint64 framePoolHits READ framePoolHits NOTIFY statsChanged)
+	Q_PROPERTY(qint64 framePoolMisses READ framePoolMisses NOTIFY statsChanged)
+	Q_PROPERTY(QString videoConvertPath READ videoConvertPath NOTIFY statsChanged)
+	Q_PROPERTY(qint64 videoPassthroughFrames READ videoPassthroughFrames NOTIFY statsChanged)
+	Q_PROPERTY(qint64 videoConvertedFrames READ videoConvertedFrames NOTIFY statsChanged)
+	Q_PROPERTY(DecodeThreadMode decodeThreadMode READ decodeThreadMode WRITE setDecodeThreadMode NOTIFY decodeThreadModeChanged)
+	Q_PROPERTY(int decodeThreadCount READ decodeThreadCount WRITE setDecodeThreadCount NOTIFY decodeThreadCountChanged)
+	Q_PROPERTY(int activeDecodeThreadCount READ activeDecodeThreadCount NOTIFY statsChanged)
+	Q_PROPERTY(QString activeDecodeThreadType READ activeDecodeThreadType NOTIFY statsChanged)
+	Q_PROPERTY(qint64 packetAllocCount READ packetAllocCount NOTIFY statsChanged)
+	Q_PROPERTY(qint64 packetReuseCount READ packetReuseCount NOTIFY statsChanged)
+	Q_PROPERTY(bool sharedScheduler READ sharedScheduler WRITE setSharedScheduler NOTIFY sharedSchedulerChanged)
+	Q_PROPERTY(QVariantList presentLatenessHistogram READ presentLatenessHistogram NOTIFY statsChanged)
+	Q_PROPERTY(double playbackSpeed READ playbackSpeed WRITE setPlaybackSpeed NOTIFY playbackSpeedChanged)
+	Q_PROPERTY(ClockMode clockMode READ clockMode WRITE setClockMode NOTIFY clockModeChanged)
+	Q_PROPERTY(ClockMode activeClockMode READ activeClockMode NOTIFY statsChanged)
+	Q_PROPERTY(qint64 avDrift READ avDrift NOTIFY statsChanged)
+	Q_PROPERTY(qint64 droppedLateFrames READ droppedLateFrames NOTIFY statsChanged)
+	Q_PROPERTY(qint64 droppedPresentFrames READ droppedPresentFrames NOTIFY statsChanged)
+	Q_PROPERTY(int frameSkipLevel READ frameSkipLevel NOTIFY statsChanged)
+	Q_PROPERTY(qint64 frameSkipEscalations READ frameSkipEscalations NOTIFY statsChanged)
+	Q_PROPERTY(qint64 lastSeekLatency READ lastSeekLatency NOTIFY statsChanged)
+	Q_PROPERTY(bool keyframeIndex READ keyframeIndex WRITE setKeyframeIndex NOTIFY keyframeIndexChanged)
+	Q_PROPERTY(bool keyframeIndexReady READ keyframeIndexReady NOTIFY statsChanged)
+	Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
+	Q_PROPERTY(bool reverse READ reverse WRITE setReverse NOTIFY reverseChanged)
+	Q_PROPERTY(bool mmapIO READ mmapIO WRITE setMmapIO NOTIFY mmapIOChanged)
+	Q_PROPERTY(int readAheadSize READ readAheadSize WRITE setReadAheadSize NOTIFY readAheadSizeChanged)
+	Q_PROPERTY(int ioThrottle READ ioThrottle WRITE setIoThrottle NOTIFY ioThrottleChanged)
+	Q_PROPERTY(qint64 readAheadHits READ readAheadHits NOTIFY statsChanged)
+	Q_PROPERTY(qint64 readAheadStalls READ readAheadStalls NOTIFY statsChanged)
+	Q_PROPERTY(qint64 readAheadStallTime READ readAheadStallTime NOTIFY statsChanged)
+	Q_PROPERTY(bool httpCache READ httpCache WRITE setHttpCache NOTIFY httpCacheChanged)
+	Q_PROPERTY(int httpCacheBudget READ httpCacheBudget WRITE setHttpCacheBudget NOTIFY httpCacheBudgetChanged)
+	Q_PROPERTY(qint64 httpCacheHits READ httpCacheHits NOTIFY statsChanged)
+	Q_PROPERTY(qint64 httpCacheMisses READ httpCacheMisses NOTIFY statsChanged)
+	Q_PROPERTY(qint64 httpCacheBytesSaved READ httpCacheBytesSaved NOTIFY statsChanged)
+	Q_PROPERTY(bool abr READ abr WRITE setAbr NOTIFY abrChanged)
+	Q_PROPERTY(int abrVariant READ abrVariant NOTIFY statsChanged)
+	Q_PROPERTY(int abrVariantCount READ abrVariantCount NOTIFY statsChanged)
+	Q_PROPERTY(qint64 abrBandwidth READ abrBandwidth NOTIFY statsChanged)
+	Q_PROPERTY(qint64 abrSwitches READ abrSwitches NOTIFY statsChanged)
+	Q_PROPERTY(qint64 abrAverageBitrate READ abrAverageBitrate NOTIFY statsChanged)
+	Q_PROPERTY(qint64 rebufferTime READ rebufferTime NOTIFY statsChanged)
+	Q_PROPERTY(LiveMode liveMode READ liveMode WRITE setLiveMode NOTIFY liveModeChanged)
+	Q_PROPERTY(bool live READ live NOTIFY statsChanged)
+	Q_PROPERTY(int liveTargetLatency READ liveTargetLatency WRITE setLiveTargetLatency NOTIFY liveTargetLatencyChanged)
+	Q_PROPERTY(qint64 liveLatency READ liveLatency NOTIFY statsChanged)
+	Q_PROPERTY(qint64 liveCatchUps READ liveCatchUps NOTIFY statsChanged)
+	Q_PROPERTY(bool probeCache READ probeCache WRITE setProbeCache NOTIFY probeCacheChanged)
+	Q_PROPERTY(bool probeCacheHit READ probeCacheHit NOTIFY statsChanged)
+	Q_PROPERTY(qint64 probeTime READ probeTime NOTIFY statsChanged)
+	Q_PROPERTY(qint64 timeToFirstFrame READ timeToFirstFrame NOTIFY statsChanged)
+	Q_PROPERTY(QStringList playlist READ playlist WRITE setPlaylist NOTIFY playlistChanged)
+	Q_PROPERTY(int playlistIndex READ playlistIndex NOTIFY playlistIndexChanged)
+	Q_PROPERTY(int preroll READ preroll WRITE setPreroll NOTIFY prerollChanged)
 
 public:
+	enum DecodeThreadMode // Ƶ̷߳ʽ´δʱЧ
+	{
+		ThreadAuto = 0, // ֧̣֡߳֡߳Ƭ߳
+		ThreadFrame,
+		ThreadSlice,
+		ThreadNone,
+	};
+	Q_ENUM(DecodeThreadMode)
+
+	enum ClockMode // ʱӣƵʱУʾʱ
+	{
+		ClockAudio = 0, // ûƵʱ˻ⲿʱ
+		ClockVideo, // ûƵʱ˻ⲿʱ
+		ClockExternal, // ӵһ֡ʼϵͳʱ
+	};
+	Q_ENUM(ClockMode)
+
+	enum SeekMode
+	{
+		SeekFast = 0, // ͣĿ긽Ĺؼ֡
+		SeekAccurate, // Ŀ֮ǰĹؼ֡룬Ŀ֮ǰ֡
+	};
+	Q_ENUM(SeekMode)
+
+	enum LiveMode // ֱӳģʽ´δʱЧ
+	{
+		LiveAuto = 0, // rtsprtmpudpʵʱַԶ
+		LiveOff,
+		LiveOn,
+	};
+	Q_ENUM(LiveMode)
+
 	QAbstractVideoSurface* videoSurface() { return m_videoSurface; }
 	void setVideoSurface(QAbstractVideoSurface* surface);
 
@@ -40,6 +151,118 @@ public:
 	void setVideoUrl(QString videoUrl);
 
 	void setFormat(int width, int heigth, QVideoFrame::PixelFormat pixFormat);
+
+	qint64 framePoolHits() { return m_framePool.hits(); }
+	qint64 framePoolMisses() { return m_framePool.misses(); }
+
+	QString videoConvertPath() { return m_videoConvertPath; } // Э̽"passthrough yuv420p"
+	qint64 videoPassthroughFrames() { return m_videoPassthroughFrames; }
+	qint64 videoConvertedFrames() { return m_videoConvertedFrames; }
+
+	DecodeThreadMode decodeThreadMode() { return m_decodeThreadMode; }
+	void setDecodeThreadMode(DecodeThreadMode mode);
+	int decodeThreadCount() { return m_decodeThreadCount; } // 0ΪԶ
+	void setDecodeThreadCount(int count);
+	int activeDecodeThreadCount() { return m_videoCodecCtx ? m_videoCodecCtx->thread_count : 0; }
+	QString activeDecodeThreadType();
+
+	qint64 packetAllocCount() { return m_packetPool.allocCount; } // ̬²
+	qint64 packetReuseCount() { return m_packetPool.reuseCount; }
+
+	// ȡͽڹִУٵ̣߳´δʱЧ
+	bool sharedScheduler() { return m_bSharedScheduler; }
+	void setSharedScheduler(bool bShared);
+
+	QVariantList presentLatenessHistogram(); // ּּ֡޼PresentScheduler::bucketLimit
+
+	double playbackSpeed() { return m_playControl.speed; }
+	void setPlaybackSpeed(double speed); // 0.25~4Ƶٲ
+
+	ClockMode clockMode() { return m_clockMode; }
+	void setClockMode(ClockMode mode);
+	ClockMode activeClockMode(); // ʵʹõʱ
+	qint64 avDrift() { return m_avDrift; } // ʾʱƵptsʱӣ΢
+
+	void setAudioOutput(QAudioOutput* output); // ڼ豸δŵʱ
+
+	// ֡ͳƣԭֿ
+	qint64 droppedLateFrames() { return m_droppedLateFrames; } // ѹڣδתֱӶ
+	qint64 droppedPresentFrames() { return m_droppedPresentFrames; } // ʾǰѹڣ滹֡ʱ
+	int frameSkipLevel() { return m_frameSkipLevel; } // 01·˲2ǲο֡3ֻؼ֡
+	qint64 frameSkipEscalations() { return m_frameSkipEscalations; } // 
+
+	// תpositionMs(ļ)ؽִֻ̣߳һ
+	Q_INVOKABLE void seek(qint64 positionMs, SeekMode mode = SeekAccurate);
+	qint64 lastSeekLatency() { return m_lastSeekLatency; } // һseekλõһ֡ʾĺʱ
+
+	// ̨Ƶؼ֡seekʱֽƫת´δʱЧ
+	bool keyframeIndex() { return m_bKeyframeIndex; }
+	void setKeyframeIndex(bool bIndex);
+	bool keyframeIndexReady() { return m_keyframeIndex.isReady(); }
+
+	// ͣͷ򲥷ʱGopCacheGOPʾָ򲥷ʱӵǰ֡seek
+	bool paused() { return m_playControl.bPause; }
+	void setPaused(bool bPause);
+	bool reverse() { return m_bReverse; }
+	void setReverse(bool bReverse);
+	Q_INVOKABLE void stepFrame(bool bForward); // ͣǰ/һ֡
+
+	// ļڴӳȡ´δʱЧ
+	bool mmapIO() { return m_bMmapIO; }
+	void setMmapIO(bool bMmap);
+
+	// ļɶI/O߳ԤλMB0Ϊرգʱڴӳ䣻´δʱЧ
+	int readAheadSize() { return m_readAheadSize; }
+	void setReadAheadSize(int sizeMB);
+	int ioThrottle() { return m_ioThrottle; } // ԤKB/sģNASٴ洢0Ϊ
+	void setIoThrottle(int kbps);
+	qint64 readAheadHits() { return m_readAheadIO.hits(); }
+	qint64 readAheadStalls() { return m_readAheadIO.stalls(); }
+	qint64 readAheadStallTime() { return m_readAheadIO.stallTime() / 1000; } // ms
+
+	// http(s)ַ̻ȡزseekصķΧ磻´δʱЧ
+	bool httpCache() { return m_bHttpCache; }
+	void setHttpCache(bool bCache);
+	int httpCacheBudget() { return m_httpCacheBudget; } // MBлĿܴС
+	void setHttpCacheBudget(int sizeMB);
+	qint64 httpCacheHits() { return m_httpCacheIO.hits(); }
+	qint64 httpCacheMisses() { return m_httpCacheIO.misses(); }
+	qint64 httpCacheBytesSaved() { return m_httpCacheIO.bytesSaved(); }
+
+	// HLSʰƬͻʱԶлvariant´δʱЧ
+	bool abr() { return m_bAbr; }
+	void setAbr(bool bAbr);
+	int abrVariant() { return m_abr.current(); } // ±꣬δʱΪ-1
+	int abrVariantCount() { return m_abr.variantCount(); }
+	qint64 abrBandwidth() { return m_abr.bandwidth(); } // bps
+	qint64 abrSwitches() { return m_abr.switches(); }
+	qint64 abrAverageBitrate() { return m_abr.averageBitrate(); } // bps
+	qint64 rebufferTime() { return m_rebufferTime / 1000; } // ʼź֡ȡյۼʱms
+
+	// ֱС̽⡢壬ѶδŵʱĿʱ΢٣ѹʱĿӳ
+	LiveMode liveMode() { return m_liveMode; }
+	void setLiveMode(LiveMode mode);
+	bool live() { return m_bLive; } // ǰǷֱ
+	int liveTargetLatency() { return m_liveTargetLatency; } // msЧ
+	void setLiveTargetLatency(int latencyMs);
+	qint64 liveLatency() { return m_liveLatency / 1000; } // İptsʱӣmsɼ紫
+	qint64 liveCatchUps() { return m_liveCatchUps; } // ׷ϵĴ
+
+	// ļ̽·С޸ʱ仺棬ʱavformat_find_stream_info´δʱЧ
+	bool probeCache() { return m_bProbeCache; }
+	void setProbeCache(bool bCache);
+	bool probeCacheHit() { return m_bProbeCacheHit; }
+	qint64 probeTime() { return m_probeTime / 1000; } // 򿪵̽ɣms
+	qint64 timeToFirstFrame() { return m_timeToFirstFrame; } // 򿪵һ֡ʾûƵʱһms
+
+	// б޷첥ţһڵǰǰprerollɺ̴̨߳򿪡̽Ⲣ򿪽
+	// ڵǰ֮ͬһУ߳ڱ߽绻Ƶд뻷ζ
+	// ڲʱֻ滻֮seekλڶȡ
+	QStringList playlist();
+	void setPlaylist(QStringList playlist);
+	int playlistIndex() { return m_playlistIndex; } // ڲŵڱ߽紦ʵʲʱ仯
+	int preroll() { return m_preroll; } // ms
+	void setPreroll(int prerollMs);
 private:
 	QAbstractVideoSurface* m_videoSurface = nullptr;
 	QVideoSurfaceFormat  m_surfaceFmt;
@@ -67,157 +290,310 @@ private:
 
 	void openAudioStream(); // Ƶ
 	void openVideoStream(); // Ƶ
+	void negotiateVideoFormat(); // surfaceֵ֧ĸʽѡʽ
+	void applyDecodeThreadConfig(AVCodecContext* codecCtx); // avcodec_open2֮ǰ
+	AVFrame* convertVideoFrame(AVFrame* srcFrame, SwsContext** swsCtx); // ʽһʱֱãswsת
 	bool openStream(std::string filePath); // ϱ
 	void closeVideoStream();
 	void closeAudioStream();
 	void closeStream();
 
-	void videoSyncClock(int lastPts); // Ƶͬ
+	int64_t videoSyncClock(int64_t lastPts); // ƵʱУ֡΢
 	void refreshVideo(); // Ƶ֡
+	void refreshReview(); // ͣ򲥷ʱGopCacheȡ֡ʾ
+	void resumeForward(); // ӵǰʾָ֡򲥷
+	void resumeClocks(); // ͣڼλûʱӴӻָĵһ֡¿ʼ
 	void updatePlayControlState(); // playcontrolر
-	void updateAudioBuffer(); // Ƶbuffer
+	size_t readAudio(uint8_t* stream, size_t len, int64_t deviceLatency); // PCMζжȡƵʱ
+	int64_t audioDeviceLatency(); // QAudioOutputдδŵʱ
+	int64_t masterClock(int64_t time); // ʱtimeʱ̵ֵδʼAV_NOPTS_VALUE
+	void reportFirstFrame(int64_t presentTime); // 򿪺һʾ򲥳ʱ¼ʱ
+	bool isVideoLate(int64_t pts); // pts(AV_TIME_BASE)ʱӳһ֡ƵΪʱʱ
+	bool dropLateVideoFrame(AVFrame* frame); // ̵߳ãʱ빤
+	void applyFrameSkipLevel();
 
 	bool playAudioEof(); // жƵǷ񲥷
 	bool playVideoEof(); // жƵǷ񲥷
 
 	void evalCacheMax(); // Ƶcache preloadֵ
 
-	bool isVideoCacheOverLoad(); // жƵǷ
-	bool isAudioCacheOverLoad(); // жƵǷ
+	// ȡһbBlockΪfalseʱȴûռʱIDLE
+	DecodeScheduler::TaskState readStep(bool bBlock);
+	DecodeScheduler::TaskState audioDecodeStep(bool bBlock);
+	DecodeScheduler::TaskState videoDecodeStep(bool bBlock);
+	// ˾д뻷ζУŲʱ˾УbBlockΪfalseseek/abortʱfalse
+	bool writeTempoOutput(bool bBlock);
 
 	static int eventLoop(void* data); // ¼ѭ
 	static int audioDecodeThread(void* data); // Ƶ
 	static int videoDecodeThread(void* data); // Ƶ
+	static int prerollThread(void* data); // Ԥ򿪲бһ
 	static int readThread(void* data); // ȡ
 	static void audioCallback(void* userdata, Uint8* stream, int len); 
 
 signals:
 	void newVideoFrame(const QVideoFrame& frame); // µƵ֡
 	void videoUrlChanged();
+	void decodeThreadModeChanged();
+	void decodeThreadCountChanged();
+	void clockModeChanged();
+	void playbackSpeedChanged();
+	void sharedSchedulerChanged();
+	void keyframeIndexChanged();
+	void pausedChanged();
+	void reverseChanged();
+	void mmapIOChanged();
+	void readAheadSizeChanged();
+	void ioThrottleChanged();
+	void httpCacheChanged();
+	void httpCacheBudgetChanged();
+	void abrChanged();
+	void liveModeChanged();
+	void liveTargetLatencyChanged();
+	void probeCacheChanged();
+	void playlistChanged();
+	void playlistIndexChanged();
+	void prerollChanged();
+	void statsChanged(); // ͳԶʱ֪ͨÿθ·
 	void dataReady(); // ʼ
 	void playFinished(); // 
 public slots:
 	void onNewVideoFrameReceived(const QVideoFrame& frame); // ȾƵ
 
 private:
-	enum class QueueState
+	static const int AUDIO_PKT_QUEUE_SIZE = 512; // Ƶ
+	static const int VIDEO_PKT_QUEUE_SIZE = 256; // Ƶ
+	static const int PKT_BATCH_SIZE = 16; // ߳һȡİ
+	static const int FRAME_BATCH_SIZE = 8; // Ƶ߳һӵ֡
+	struct PacketBatch // ߳һȡһEAGAINʱδĲ
 	{
-		NORMAL = 0,
-		EMPTY,
-		FULL,
-		LAST,
+		PacketPool& pool;
+		AVPacket* pkts[PKT_BATCH_SIZE];
+		size_t count = 0; // 
+		size_t inx = 0; // һİ
+		bool bLast = false; // ֮ǽ
+		int serial = 0; // seek
+		int streamIndex = -1; // İ
+		int switchTo = -1; // (л)ˢǣȽ߳ȡ֡󻻽
+
+		PacketBatch(PacketPool& p) : pool(p)
+		{
+			for (AVPacket*& pkt : pkts)
+			{
+				pkt = pool.acquire();
+			}
+		}
+		~PacketBatch()
+		{
+			for (AVPacket* pkt : pkts)
+			{
+				pool.release(pkt);
+			}
+		}
+		// ҪʱãŴӶһȡпõİ
+		// ΪʱfalsebBlockΪtrueʱֻabortŻΪ
+		// seek֮ǰİ(serialcurSerial)ֱӶʱɶȡ̻߳ΪAV_TIME_BASE
+		bool feed(AVCodecContext* codecCtx, PacketQueue& queue, bool bBlock, int curSerial)
+		{
+			if (serial != curSerial)
+			{
+				count = inx = 0;
+				bLast = false;
+				switchTo = -1;
+			}
+			if (inx == count && !bLast)
+			{
+				QueueState state = bBlock ? queue.waitPopBatch(pkts, PKT_BATCH_SIZE, &count, &serial) :
+					queue.popBatch(pkts, PKT_BATCH_SIZE, &count, &serial);
+				if (state == QueueState::EMPTY)
+				{
+					return false;
+				}
+				inx = 0;
+				if (serial != curSerial)
+				{
+					count = 0;
+					return true;
+				}
+				bLast = state == QueueState::LAST;
+				for (size_t i = 0; i < count; ++i)
+				{
+					av_packet_rescale_ts(pkts[i], { 1, AV_TIME_BASE }, codecCtx->time_base);
+				}
+			}
+			while (inx < count)
+			{
+				if (streamIndex >= 0 && pkts[inx]->stream_index != streamIndex)
+				{
+					if (switchTo < 0)
+					{
+						avcodec_send_packet(codecCtx, nullptr);
+						switchTo = pkts[inx]->stream_index;
+					}
+					return true;
+				}
+				streamIndex = pkts[inx]->stream_index;
+				// ʣİȡ֡
+				if (avcodec_send_packet(codecCtx, pkts[inx]) == AVERROR(EAGAIN))
+				{
+					return true;
+				}
+				++inx;
+			}
+			if (bLast)
+			{
+				avcodec_send_packet(codecCtx, nullptr);
+			}
+			return true;
+		}
+		void reset() // ߳˳
+		{
+			for (AVPacket* pkt : pkts)
+			{
+				av_packet_unref(pkt);
+			}
+			count = 0;
+			inx = 0;
+			bLast = false;
+			serial = 0;
+			streamIndex = -1;
+			switchTo = -1;
+		}
 	};
-	struct PacketQueue // AVPacket
+
+	struct PreparedCodec // ȡ߳ΪлбԤȴ򿪵Ľ
 	{
-		std::queue<AVPacket*> data;
+		int streamIndex;
+		AVCodecContext* codecCtx;
+	};
+
+	// ׼ȺУ̰߳stream_indexȡ
+	// Ԥ򿪴ڵʱһĽܻûϣֻһ
+	struct PreparedCodecQueue
+	{
+		std::deque<PreparedCodec> codecs;
 		SDL_mutex* mutex = nullptr;
-		PacketQueue()
+		PreparedCodecQueue()
 		{
 			mutex = SDL_CreateMutex();
 		}
-		~PacketQueue()
+		~PreparedCodecQueue()
 		{
+			clear();
 			SDL_DestroyMutex(mutex);
 		}
-		QueueState push(AVPacket* input)
+		void push(int streamIndex, AVCodecContext* codecCtx)
 		{
-			QueueState state = QueueState::NORMAL;
 			SDL_LockMutex(mutex);
-			do
-			{
-				AVPacket* pkt = nullptr;
-				if (input)
-				{
-					pkt = av_packet_alloc();
-					av_packet_unref(pkt);
-					av_packet_move_ref(pkt, input);
-				}
-				data.push(pkt);
-				//  
-				// todo: FULL
-				// state = QueueState::FULL;
-				//
-			} while (0);
+			codecs.push_back(PreparedCodec{ streamIndex, codecCtx });
 			SDL_UnlockMutex(mutex);
-			return state;
 		}
-		QueueState pop(AVPacket* output)
+		// ûʱnullptrǰѱ֮лȡһͷ
+		AVCodecContext* take(int streamIndex)
 		{
-			QueueState state = QueueState::NORMAL;
-			AVPacket* front = nullptr;
+			AVCodecContext* codecCtx = nullptr;
 			SDL_LockMutex(mutex);
-			do 
+			auto found = std::find_if(codecs.begin(), codecs.end(),
+				[streamIndex](const PreparedCodec& prepared) { return prepared.streamIndex == streamIndex; });
+			if (found != codecs.end())
 			{
-				if (data.size() == 0)
-				{
-					state = QueueState::EMPTY;
-					break;
-				}
-				front = data.front();
-				data.pop();
-				if (!front)
+				codecCtx = found->codecCtx;
+				for (auto it = codecs.begin(); it != found; ++it)
 				{
-					state = QueueState::LAST;
+					avcodec_free_context(&it->codecCtx);
 				}
-			} while (0);
+				codecs.erase(codecs.begin(), found + 1);
+			}
 			SDL_UnlockMutex(mutex);
-			if (front)
+			return codecCtx;
+		}
+		void clear()
+		{
+			SDL_LockMutex(mutex);
+			for (PreparedCodec& prepared : codecs)
 			{
-				av_packet_unref(output);
-				av_packet_move_ref(output, front);
-				av_packet_free(&front);
+				avcodec_free_context(&prepared.codecCtx);
 			}
-			return state;
+			codecs.clear();
+			SDL_UnlockMutex(mutex);
 		}
 	};
 
+	struct PlaylistItem // Ԥ򿪵һԤ߳д룬ȡ̵߳ȸ߳̽ȡ
+	{
+		int index = -1; // ڲбе±
+		AVFormatContext* fmtCtx = nullptr;
+		int audioIndex = -1;
+		int videoIndex = -1;
+		AVCodecContext* audioCtx = nullptr; // ǰûжӦ̻߳ʧʱΪգ
+		AVCodecContext* videoCtx = nullptr;
+	};
+
 	struct VideoData // Ƶݽṹ
 	{
-		void* pVideoBuffer;
+		AVFrame* pFrame; // ü֡bufferFramePool
 		int nBufferSize;
 		int sdlRenderLinePixelNum;
-		int framePts;
-		VideoData(void* videoBuffer, int bufferSize, int linePixelNum, int pts)
-			: nBufferSize(bufferSize)
-			, sdlRenderLinePixelNum(linePixelNum)
+		int64_t framePts;
+		int serial; // ʱseekţeventLoopŵ֡
+		bool bDiscontinuity = false; // ֱ׷Ϻĵһ֡һ֡pts
+		VideoData(AVFrame* frame, int bufferSize, int64_t pts, int seekSerial)
+			: pFrame(frame)
+			, nBufferSize(bufferSize)
+			, sdlRenderLinePixelNum(frame->linesize[0])
 			, framePts(pts)
+			, serial(seekSerial)
 		{
-			pVideoBuffer = av_mallocz(bufferSize);
-			memcpy(pVideoBuffer, videoBuffer, bufferSize);
 		}
 		~VideoData()
 		{
-			av_free(pVideoBuffer);
+			av_frame_free(&pFrame);
 		}
 	};
 	struct VideoFrameQueue // Ƶݶ
 	{
 		std::queue<VideoData*> data;
+		std::atomic<size_t> count{ 0 }; // data.size()һ£ѯ
 		unsigned long long totalDataByte = 0;
 		SDL_mutex* mutex = nullptr;
+		SDL_cond* cond = nullptr; // push/pop/abortʱ㲥
+		bool bAbort = false;
+		std::function<void()> listener; // пռʱãģʽ»ѹĽ
 
 		VideoFrameQueue()
 		{
 			mutex = SDL_CreateMutex();
+			cond = SDL_CreateCond();
 		}
 		~VideoFrameQueue()
 		{
+			SDL_DestroyCond(cond);
 			SDL_DestroyMutex(mutex);
 		}
 		QueueState push(VideoData* input)
+		{
+			return pushBatch(&input, 1);
+		}
+		// һμnֻ֡㲥һ
+		QueueState pushBatch(VideoData** inputs, size_t n)
 		{
 			QueueState state = QueueState::NORMAL;
 			
 			SDL_LockMutex(mutex);
 			do
 			{
-				data.push(input);
-				totalDataByte += input->nBufferSize;
+				for (size_t i = 0; i < n; ++i)
+				{
+					data.push(inputs[i]);
+					totalDataByte += inputs[i]->nBufferSize;
+				}
+				count.store(data.size(), std::memory_order_release);
 				//  
 				// todo: FULL
 				// state = QueueState::FULL;
 				//
 			} while (0);
+			SDL_CondBroadcast(cond);
 			SDL_UnlockMutex(mutex);
 			return state;
 		}
@@ -234,100 +610,84 @@ private:
 				}
 				*output = data.front();
 				data.pop();
+				count.store(data.size(), std::memory_order_release);
 				totalDataByte -= (*output)->nBufferSize;
+				SDL_CondBroadcast(cond);
 			} while (0);
 			SDL_UnlockMutex(mutex);
+			if (state == QueueState::NORMAL && listener)
+			{
+				listener();
+			}
 			return state;
 		}
-		QueueState getCurState()
+		// ȴݣʱabortEMPTY
+		QueueState waitPop(VideoData** output, int timeoutMs)
 		{
-			QueueState state = QueueState::NORMAL;
 			SDL_LockMutex(mutex);
-			if (data.size() == 0)
+			if (data.size() == 0 && !bAbort)
 			{
-				state = QueueState::EMPTY;
+				SDL_CondWaitTimeout(cond, mutex, timeoutMs);
 			}
 			SDL_UnlockMutex(mutex);
-			return state;
-		}
-	};
-
-	struct AudioData // Ƶ
-	{
-		void* pAudioBuffer;
-		int nBufferSize;
-		int framePts;
-		AudioData(void* audioBuffer, int bufferSize, int pts)
-			: nBufferSize(bufferSize)
-			, framePts(pts)
-		{
-			pAudioBuffer = av_mallocz(bufferSize);
-			memcpy(pAudioBuffer, audioBuffer, bufferSize);
+			return pop(output);
 		}
-		~AudioData()
+		bool isBelow(unsigned long long maxByte)
 		{
-			av_free(pAudioBuffer);
-		}
-	};
-	struct AudioFrameQueue // Ƶݶ
-	{
-		std::queue<AudioData*> data;
-		unsigned long long totalDataByte = 0;
-		SDL_mutex* mutex = nullptr;
-
-		AudioFrameQueue()
-		{
-			mutex = SDL_CreateMutex();
-		}
-		~AudioFrameQueue()
-		{
-			SDL_DestroyMutex(mutex);
+			SDL_LockMutex(mutex);
+			bool bBelow = totalDataByte < maxByte;
+			SDL_UnlockMutex(mutex);
+			return bBelow;
 		}
-		QueueState push(AudioData* input)
+		// ֱmaxByte
+		void waitBelow(unsigned long long maxByte)
 		{
-			QueueState state = QueueState::NORMAL;
-
 			SDL_LockMutex(mutex);
-			do
+			while (totalDataByte >= maxByte && !bAbort)
 			{
-				data.push(input);
-				totalDataByte += input->nBufferSize;
-				//  
-				// todo: FULL
-				// state = QueueState::FULL;
-				//
-			} while (0);
+				SDL_CondWait(cond, mutex);
+			}
 			SDL_UnlockMutex(mutex);
-			return state;
 		}
-		QueueState pop(AudioData** output)
+		// ͷ֡waitBelow
+		void clear()
 		{
-			QueueState state = QueueState::NORMAL;
 			SDL_LockMutex(mutex);
-			do
+			while (!data.empty())
 			{
-				if (data.size() == 0)
-				{
-					state = QueueState::EMPTY;
-					break;
-				}
-				*output = data.front();
+				delete data.front();
 				data.pop();
-				totalDataByte -= (*output)->nBufferSize;
-			} while (0);
+			}
+			count.store(0, std::memory_order_release);
+			totalDataByte = 0;
+			SDL_CondBroadcast(cond);
 			SDL_UnlockMutex(mutex);
-			return state;
+			if (listener)
+			{
+				listener();
+			}
 		}
-		QueueState getCurState()
+		void abort()
 		{
-			QueueState state = QueueState::NORMAL;
 			SDL_LockMutex(mutex);
-			if (data.size() == 0)
+			bAbort = true;
+			SDL_CondBroadcast(cond);
+			SDL_UnlockMutex(mutex);
+			if (listener)
 			{
-				state = QueueState::EMPTY;
+				listener();
 			}
+		}
+		void reset() // ߺ߶˳
+		{
+			clear();
+			SDL_LockMutex(mutex);
+			bAbort = false;
 			SDL_UnlockMutex(mutex);
-			return state;
+		}
+		QueueState getCurState()
+		{
+			return count.load(std::memory_order_acquire) == 0 ? QueueState::EMPTY : QueueState::NORMAL;
 		}
 	};
 
@@ -349,48 +709,203 @@ private:
 		bool bPlayEof = false; // 
 
 		bool bAbort = false; // ֹ
-		bool bPause = false;
+		bool bPause = false; // ͣ򲽽Уˮ߲
 		bool bAutoStart = false;
-		float speed = 1.0; // 
+		std::atomic<float> speed{ 1.0f }; // ţ0.25~4
 
-		int64_t seekingTime = -1;
+		WaitEvent stateEvent; // ״̬仯ʱeventLoop
+
+		int64_t seekingTime = -1; // AV_TIME_BASEѼstart_time
+		bool bSeekAccurate = true;
+		int seekItem = 0; // seekʱڲŵĲб
+		int64_t seekItemBase = 0; // ʱϵλ
+		std::atomic<int> seekSerial{ 0 }; // ÿseek1ڷֱ仯ʱ
 		SDL_mutex* seekMutex; // seek
 
+		// ȡһseekĿ꣬
+		int currentSeek(int64_t* target, bool* bAccurate, int* item = nullptr, int64_t* itemBase = nullptr)
+		{
+			SDL_LockMutex(seekMutex);
+			int serial = seekSerial;
+			*target = seekingTime;
+			*bAccurate = bSeekAccurate;
+			if (item)
+			{
+				*item = seekItem;
+				*itemBase = seekItemBase;
+			}
+			SDL_UnlockMutex(seekMutex);
+			return serial;
+		}
+		// eventLoopseekòɱǣȡͽıɸԼ
 		void seek()
 		{
-			bReadEof = false;
-			bAudioDecodeEof = false;
-			bVideoDecodeEof = false;
 			bPlayAudioEof = false;
 			bPlayVideoEof = false;
 			bPlayEof = false;
-			bPause = false;
 		}
 	};
 
-	AVFormatContext* m_fmtCtx = nullptr;
+	// HLSл
+	static int abrIoOpen(AVFormatContext* s, AVIOContext** pb, const char* url, int flags, AVDictionary** options);
+	static void abrIoClose(AVFormatContext* s, AVIOContext* pb); // Ƭرʱ
+	int64_t ioBusyClock();
+	bool abrFilterPacket(AVPacket* pkt); // ȡ̵߳ãfalseʱ
+	void abrStartSwitch(int target);
+	bool isCodecCompatible(AVCodecContext* codecCtx, AVCodecParameters* par); // ʱܷý
+	AVCodecContext* openSwitchCodec(AVStream* stream, AVCodecContext* like);
+	void prepareSwitchCodec(AVCodecContext* codecCtx, int streamIndex, PreparedCodecQueue& prepared);
+	// ̵߳ãtrueʾµĽ
+	bool switchDecoder(AVCodecContext** codecCtx, int streamIndex, PreparedCodecQueue& prepared,
+		std::vector<AVCodecContext*>& retired);
+
+	static int abortInterruptCallback(void* data); // رʱжеȡʹ
+
+	// ֱ
+	static bool isLiveUrl(const std::string& url);
+	void updateLiveLatency(); // eventLoop
+	void applyPlaybackSpeed(float speed); // ٶȲֱ֪ͨ׷ʱeventLoop
+	void reopenStream(); // رյǰٰm_filePath
+	void resetStreamState(); // closeStream߳˳ãָٴopenStream״̬
 
-	AVPacket* m_pRreadPkt;
+	AVFormatContext* m_fmtCtx = nullptr;
+	bool m_bMmapIO = false;
+	MmapIO m_mmapIO; // m_fmtCtxԶpbرm_fmtCtx֮ͷ
+	int m_readAheadSize = 0;
+	int m_ioThrottle = 0;
+	ReadAheadIO m_readAheadIO; // ͬ
+	bool m_bHttpCache = false;
+	int m_httpCacheBudget = 2048;
+	HttpCacheIO m_httpCacheIO; // ͬ
+	bool m_bProbeCache = false;
+	bool m_bProbeCacheHit = false;
+	ProbeCache m_probeCache;
+	int64_t m_probeTime = 0;
+	std::atomic<int64_t> m_openStartTime{ 0 }; // openStreamʼʱav_gettime_relativeһ֡
+	std::atomic<qint64> m_timeToFirstFrame{ 0 };
+
+	// ⸴ͳƣֻav_read_frameڵĺʱ
+	int64_t m_demuxPackets = 0;
+	int64_t m_demuxBytes = 0;
+	int64_t m_demuxTime = 0;
+
+	// HLSʣлߺdiscardڶȡ̣߳ڸԵĽ̸߳
+	bool m_bAbr = false;
+	AbrController m_abr;
+	int m_abrSwitching = -1; // лvariantİ֮ǰ¾
+	int64_t m_abrReadPts = AV_NOPTS_VALUE; // ƵptsAV_TIME_BASEȥǰ֡ʱ
+	int64_t m_abrLastCheck = 0;
+	int64_t m_ioBusyTime = 0; // ڴ򿪡̽av_read_frameеۼʱ
+	int64_t m_ioBusyStart = 0; // Ϊ0ʱ
+	int (*m_defaultIoOpen)(AVFormatContext*, AVIOContext**, const char*, int, AVDictionary**) = nullptr;
+	void (*m_defaultIoClose)(AVFormatContext*, AVIOContext*) = nullptr;
+	PreparedCodecQueue m_preparedAudioCodecs;
+	PreparedCodecQueue m_preparedVideoCodecs;
+	std::vector<AVCodecContext*> m_retiredAudioCtx; // µĽ߳̿ڶȡtime_baseȣرʱͷ
+	std::vector<AVCodecContext*> m_retiredVideoCtx;
+	const int64_t ABR_CHECK_INTERVAL = AV_TIME_BASE / 2;
+
+	// ֱ׷eventLoopڸԵĽִ߳
+	LiveMode m_liveMode = LiveAuto;
+	bool m_bLive = false;
+	std::atomic<int> m_liveTargetLatency{ 500 };
+	std::atomic<int64_t> m_liveReadPts{ AV_NOPTS_VALUE }; // İptsAV_TIME_BASE
+	std::atomic<int64_t> m_liveLatency{ 0 };
+	std::atomic<qint64> m_liveCatchUps{ 0 };
+	std::atomic<int> m_liveCatchUpSerial{ 0 }; // ÿ׷ϼ1
+	std::atomic<int64_t> m_liveCatchUpTarget{ AV_NOPTS_VALUE }; // ʱֵ̲֡
+	int m_audioCatchUpSerial = 0; // ƵѴ׷
+	int m_videoCatchUpSerial = 0;
+	bool m_bVideoDiscontinuity = false; // ֻƵ̷߳
+	int64_t m_liveLastCheck = 0; // ֻeventLoop
+	int64_t m_liveCatchUpTime = 0;
+	std::atomic<bool> m_bLiveResumed{ false }; // ָͣѹֱֵ׷
+	bool m_bLiveSpeedUp = false;
+	const int64_t LIVE_CHECK_INTERVAL = AV_TIME_BASE / 5;
+	const int64_t LIVE_SPEED_UP_MARGIN = AV_TIME_BASE / 10; // Ŀô࿪ʼ
+	const int64_t LIVE_DROP_MARGIN = AV_TIME_BASE; // ĿôֱӶ׷
+	const int64_t LIVE_SETTLE_TIME = AV_TIME_BASE; // ʱӸλ֮ǰж
+	const float LIVE_SPEED_UP = 1.05f; // 仯С
+	const int LIVE_PROBE_SIZE = 256 * 1024;
+	const int64_t LIVE_ANALYZE_DURATION = AV_TIME_BASE / 2;
+	const int64_t LIVE_MAX_DELAY = AV_TIME_BASE / 10; // rtpȴ
+	const int64_t LIVE_RW_TIMEOUT = 5 * AV_TIME_BASE; // ʱȡش󣬲Ž
+
+	// б
+	AVFormatContext* readFormatContext() // ڶȡm_fmtCtxرգcodecparʽ
+	{
+		return m_playlistCtx ? m_playlistCtx : m_fmtCtx;
+	}
+	void normalizePacket(AVFormatContext* fmtCtx, AVPacket* pkt); // ȡ߳ǰ
+	bool startPreroll(); // ûһʱfalse
+	bool playlistAdvance(); // ȡ߳ڵǰʱãһtrue
+	bool reopenPlaylistItem(int index, int64_t base); // ȡ߳seekڶȡʱ
+	void installPlaylistItem(PlaylistItem* item, int64_t base); // ϴ򿪵ʱbaseʼ
+	void finishPreroll(); // ȴԤ߳˳m_prerollItem
+	PlaylistItem* openPlaylistItem(const std::string& url, int index);
+	void freePlaylistItem(PlaylistItem* item);
+	void updatePlaylistIndex(); // eventLoopãʱԽ߽ʱplaylistIndex
+
+	QStringList m_playlist;
+	SDL_mutex* m_playlistMutex = SDL_CreateMutex(); // m_playlistm_playlistBoundariesm_prerollThread
+	std::atomic<int> m_playlistIndex{ 0 };
+	std::atomic<int> m_preroll{ 5000 };
+	AVFormatContext* m_playlistCtx = nullptr; // ڶڶȡֻڶȡ̷߳
+	int m_playlistReadIndex = 0;
+	int m_playlistStreamBase = 0; // ӵstream_indexϣ߳̾ݴ˷ֻ
+	int64_t m_playlistOffset = 0; // ӵʱϣAV_TIME_BASE
+	int64_t m_playlistItemEnd = AV_NOPTS_VALUE; // ʱƵıʱ̣ʱ
+	int64_t m_playlistReadEnd = AV_NOPTS_VALUE; // Ѷİʱ̣һ
+	std::atomic<int64_t> m_playlistItemBase{ 0 }; // ڶȡʱϵλ
+	std::atomic<int64_t> m_playlistPresentBase{ 0 }; // ڲŵ㣬seekʱʹãplaylistIndex
+	bool m_bPrerolling = false; // ѿʼԤ򿪣ûȡ߽
+	SDL_Thread* m_prerollThread = nullptr; // ȡ̺߳closeStream˭ȡ˭ȴ
+	SDL_sem* m_prerollDone = SDL_CreateSemaphore(0); // Ԥɣٷʽ
+	std::string m_prerollUrl;
+	int m_prerollIndex = -1;
+	PlaylistItem* m_prerollItem = nullptr; // ʧΪ
+	std::deque<std::pair<int64_t, int>> m_playlistBoundaries; // ±꣬ȡ˳
+	std::atomic<int> m_playlistBoundaryCount{ 0 };
+	int m_presentItemCount = 0; // ѲĻֻeventLoop
+	static const int PLAYLIST_STREAM_STRIDE = 1024; // ÿstream_index
+
+	// Ƶ֡bufferأ֮֡ǰ
+	FramePool m_framePool;
+
+	AVPacket* m_pRreadPkt = nullptr;
+	PacketQueue* m_pReadPendingQue = nullptr; // δдm_pRreadPkt
+	bool m_bReadEnd = false; // ȡд
+	int m_readEndQueued = 0; // ѴǵĶƵƵ
+	int m_readSerial = 0; // ȡ߳Ѵseek
+	bool m_bKeyframeIndex = false;
+	KeyframeIndex m_keyframeIndex;
 	AVFrame* m_pAudioFrame;
 	AVFrame* m_pVideoFrame;
-	AVFrame* m_pVideoOutFrame;
 
-	// 
-	PacketQueue m_audioPktQue;
-	PacketQueue m_videoPktQue;
-	// ֡
-	AudioFrameQueue m_audioFrameQue;
+	// УslotеAVPacketm_packetPool
+	PacketPool m_packetPool;
+	PacketQueue m_audioPktQue{ AUDIO_PKT_QUEUE_SIZE, m_packetPool };
+	PacketQueue m_videoPktQue{ VIDEO_PKT_QUEUE_SIZE, m_packetPool };
+	PacketBatch m_audioBatch{ m_packetPool };
+	PacketBatch m_videoBatch{ m_packetPool };
+	// Ƶ֡
 	VideoFrameQueue m_videoFrameQue;
 
 	// audio 
-	void* m_audioBuff = nullptr; // زbuffer
-	int m_audioBufferCurInx = -1; // sdlcallback
-	int m_audioBufferSize = 0; // sdlcallback
-	AudioData* m_curAudioData = nullptr; // sdlcallback
-	int m_audioBufferTotalSize = 0;
+	AudioRingBuffer m_audioRing; // زPCM
+	uint8_t* m_audioConvertBuf = nullptr; // ζβռ䲻ʱزbuffer
+	unsigned int m_audioConvertBufSize = 0;
+	int m_audioRecRet = 0; // ϴavcodec_receive_frameķֵ
+	bool m_bAudioFramePending = false; // m_pAudioFrameȡζпռ䲻㣬δд
+	AudioTempo m_audioTempo; // ֻƵ̷߳
+	float m_audioTempoSpeed = 1.0f; // m_audioTempoٶȽʼʧʱҲ
+	std::atomic<int> m_audioSerial{ 0 }; // ƵѴseek
+	int64_t m_audioDropUntil = AV_NOPTS_VALUE; // ȷseekʱʱֵ̲֡
+	int64_t m_audioLastEnd = AV_NOPTS_VALUE; // д뻷ζе֡Ľʱ̣ʱݴȥص
 	int m_nAudioInx = -1; // Ƶ
 	int m_nChannelFormatByte; // Ƶchannel*format
-	int64_t m_audioClk = 0; // Ƶʱ
+	QAudioOutput* m_audioOutput = nullptr;
+	int64_t m_audioBytesDelivered = 0; // ѽQAudioOutputֽľ
 	AVCodecContext* m_audioCodecCtx = nullptr;
 	SwrContext* m_swrCtx = nullptr;
 	AVCodecParameters* m_pAudioCodecParam = nullptr;// Ƶ
@@ -399,12 +914,58 @@ private:
 	QAudioFormat m_audioFormat;
 
 	// video 
-	void* m_pVideoOutBuffer;
 	int m_videoOutBufferSize;
 	int m_videoDisplayDelay = 0;
 	int m_nVideoInx = -1; // Ƶ
 	int m_nOutputBufferSize = 0;
-	int64_t m_videoClk = 0; // Ƶʱ
+	std::atomic<int64_t> m_videoClk{ 0 }; // ǰ֡ptseventLoopдָʱڽ̶߳
+	int64_t m_videoFrameDuration = 0; // ֡ʹƣpts쳣ʱʹ
+	PresentScheduler m_presentScheduler;
+	std::atomic<int> m_videoSerial{ 0 }; // ƵѴseek
+	int64_t m_videoDropUntil = AV_NOPTS_VALUE; // ȷseekʱptsСڴֵ֡
+	int64_t m_videoLastPts = AV_NOPTS_VALUE; // ֡ptsʱݴȥص
+	int64_t m_rebufferStart = 0; // ֻeventLoop
+	std::atomic<int64_t> m_rebufferTime{ 0 };
+	int m_presentSerial = 0; // ʾ֡seek
+	std::atomic<int> m_resumeSerial{ 0 }; // ÿβseekĻָ1ָĵһ֡ʾ
+	int m_presentResumeSerial = 0; // ֻeventLoop
+
+	// ͣ򲥷
+	std::atomic<bool> m_bReverse{ false };
+	std::atomic<int> m_stepRequest{ 0 }; // ִеĲ֡Ϊ
+	GopCache m_gopCache; // һνͣʱ
+	bool m_bReviewable = false; // ؿseekļGopCacheֱԴ´
+	struct SwsContext* m_reviewSwsCtx = nullptr; // GopCache߳ʹ
+	bool m_bInReview = false; // ֻeventLoop
+	std::atomic<bool> m_bReviewMoved{ false }; // ͣвʾGopCacheָ֡ʱҪseek
+	int m_reviewSerial = 0; // ͣѴseek
+	std::atomic<int64_t> m_seekRequestTime{ 0 }; // seekʱav_gettime_relative
+	std::atomic<qint64> m_lastSeekLatency{ 0 };
+
+	// ʱ
+	ClockMode m_clockMode = ClockAudio;
+	MediaClock m_audioClock; // ڲŵƵptsѿ۳豸
+	MediaClock m_videoClock; // ʾƵ֡pts
+	MediaClock m_externalClock;
+	std::atomic<qint64> m_avDrift{ 0 };
+
+	// ֡m_lateStreakֻڽ̷߳
+	std::atomic<int> m_frameSkipLevel{ 0 };
+	int m_lateStreak = 0; // ֡
+	int m_onTimeStreak = 0; // δ֡
+	int m_consecutiveDrops = 0;
+	int m_consecutivePresentDrops = 0; // ʾǰֻ֡eventLoop
+	std::atomic<qint64> m_droppedLateFrames{ 0 };
+	std::atomic<qint64> m_droppedPresentFrames{ 0 };
+	std::atomic<qint64> m_frameSkipEscalations{ 0 };
+	const int SKIP_ESCALATE_FRAMES = 8; // ô֡һ
+	const int SKIP_RECOVER_FRAMES = 60; // ʱô֡һ
+	const int MAX_SKIP_LEVEL = 3;
+	const int MAX_CONSECUTIVE_DROPS = 8; // ô֡һ֡ȥ治ͣס
+
+	const double MIN_PLAYBACK_SPEED = 0.25;
+	const double MAX_PLAYBACK_SPEED = 4.0;
+	int m_videoRecRet = 0;
 	AVCodecContext* m_videoCodecCtx = nullptr;
 	struct SwsContext* m_swsCtx = nullptr;
 	AVCodecParameters* m_pVideoCodecParam = nullptr; // Ƶ
@@ -414,14 +975,32 @@ private:
 	SDL_Rect m_textureRect;
 	//int preset[2] = { AV_PIX_FMT_YUYV422, SDL_PIXELFORMAT_YUY2 };
 	int preset[2] = { AV_PIX_FMT_YUV420P, SDL_PIXELFORMAT_YUY2 };
+	AVPixelFormat m_videoOutFmt = AV_PIX_FMT_NONE; // surfaceЭ̵ʽ
+	DecodeThreadMode m_decodeThreadMode = ThreadAuto;
+	int m_decodeThreadCount = 0;
+	QString m_videoConvertPath;
+	std::atomic<qint64> m_videoPassthroughFrames{ 0 };
+	std::atomic<qint64> m_videoConvertedFrames{ 0 };
 	VideoData* m_curVideoData = nullptr;
 	VideoData* m_lastVideoData = nullptr;
-	std::shared_ptr<QVideoFrame> m_frame = nullptr;
 
-	SDL_Thread* m_audioDecThread; // Ƶ߳
-	SDL_Thread* m_videoDecThread; // Ƶ߳
-	SDL_Thread* m_readThread; // ȡ߳
-	SDL_Thread* m_eventLoopThread; // ȡ߳
+	SDL_Thread* m_audioDecThread = nullptr; // Ƶ߳
+	SDL_Thread* m_videoDecThread = nullptr; // Ƶ߳
+	SDL_Thread* m_readThread = nullptr; // ȡ߳
+	SDL_Thread* m_eventLoopThread = nullptr; // ¼ѭ߳
+	bool m_bSharedScheduler = false;
+	// ģʽ´ϱߵ̣֪߳ͨʱ﻽ѣÿպٻ
+	std::atomic<DecodeScheduler::Task*> m_audioDecTask{ nullptr };
+	std::atomic<DecodeScheduler::Task*> m_videoDecTask{ nullptr };
+	std::atomic<DecodeScheduler::Task*> m_readTask{ nullptr };
+	SDL_mutex* m_taskMutex = SDL_CreateMutex(); // ڼ񲻱ͷ
+	void connectTaskWake(); // ʱãк״̬֪ͨѵȴ
+	void wakeTask(std::atomic<DecodeScheduler::Task*>& task);
+	void waitTask(std::atomic<DecodeScheduler::Task*>& task); // ÿպȴ
+
+	// ͳֵڸ߳֡£ɽ̵߳Ķʱ֪ͨ
+	QTimer m_statsTimer;
+	void startStatsTimer(); // ʱ
 
 	// ״̬
 	PlayControlState m_playControl;
@@ -431,6 +1010,11 @@ private:
 	bool m_bInitSuccessful = false; // ʼɹ
 
 	const int PRELOADSEC = 1; // Ԥ3
+	const int PIPELINE_THREAD_NUM = 3; // ȡƵ롢¼ѭ̣߳Զ߳ʱԤ
+	const int MAX_DECODE_THREAD_NUM = 16; // ffmpeg̳֡߳16澯
 	int m_videoCacheMaxByte = 0;
 	int m_audioCacheMaxByte = 0;
+	const int REFRESH_WAIT_MS = 10; // eventLoopȴƵ֡ĳʱ
+	const int EVENT_WAIT_MS = 100; // eventLoopƵˢʱĵȴʱ
+	const int STATS_NOTIFY_MS = 500; // statsChanged֪ͨ
 };
@@ -0,0 +1,68 @@
+#include "FramePool.h"
+
+FramePool::FramePool()
+{
+	m_mutex = SDL_CreateMutex();
+}
+
+FramePool::~FramePool()
+{
+	// ʹеbuffer黹poolͷ
+	for (auto& it : m_pools)
+	{
+		av_buffer_pool_uninit(&it.second);
+	}
+	SDL_DestroyMutex(m_mutex);
+}
+
+AVBufferRef* FramePool::get(int size)
+{
+	int poolSize = FFMAX(classSize(size), MIN_CLASS_SIZE);
+	AVBufferPool* pool = nullptr;
+	SDL_LockMutex(m_mutex);
+	auto it = m_pools.find(poolSize);
+	if (it == m_pools.end())
+	{
+		pool = av_buffer_pool_init2(poolSize, this, allocBuffer, nullptr);
+		m_pools[poolSize] = pool;
+	}
+	else
+	{
+		pool = it->second;
+	}
+	SDL_UnlockMutex(m_mutex);
+
+	m_requests++;
+	return av_buffer_pool_get(pool);
+}
+
+int FramePool::classSize(int size)
+{
+	int pow2 = 1;
+	while (pow2 < size)
+	{
+		pow2 <<= 1;
+	}
+	if (pow2 < 8)
+	{
+		return pow2;
+	}
+	int step = pow2 / 8; // (pow2/2, pow2]4
+	int classSize = pow2 / 2;
+	while (classSize < size)
+	{
+		classSize += step;
+	}
+	return classSize;
+}
+
+#if FF_API_BUFFER_SIZE_T
+AVBufferRef* FramePool::allocBuffer(void* opaque, int size)
+#else
+AVBufferRef* FramePool::allocBuffer(void* opaque, size_t size)
+#endif
+{
+	FramePool* obj = static_cast<FramePool*>(opaque);
+	obj->m_misses++;
+	return av_buffer_alloc(size);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+#include <atomic>
+
+extern "C"
+{
+#include "libavutil/avutil.h"
+#include "libavutil/buffer.h"
+#include "SDL2/SDL.h"
+}
+
+// Сּ֡أÿּһAVBufferPool
+// ֱʱ仯ʱ䵽µķּɷּbufferԿɸ
+class FramePool
+{
+public:
+	FramePool();
+	~FramePool();
+
+	// sizeֽڵbufferav_buffer_unref黹
+	AVBufferRef* get(int size);
+
+	unsigned long long hits() const
+	{
+		return m_requests.load() - m_misses.load();
+	}
+	unsigned long long misses() const
+	{
+		return m_misses.load();
+	}
+
+private:
+	static int classSize(int size); // ּСÿ24
+#if FF_API_BUFFER_SIZE_T
+	static AVBufferRef* allocBuffer(void* opaque, int size);
+#else
+	static AVBufferRef* allocBuffer(void* opaque, size_t size);
+#endif
+
+	std::map<int, AVBufferPool*> m_pools; // ּС -> pool
+	SDL_mutex* m_mutex = nullptr;
+
+	std::atomic<unsigned long long> m_requests{ 0 };
+	std::atomic<unsigned long long> m_misses{ 0 }; // poolΪҪ·Ĵ
+
+	const int MIN_CLASS_SIZE = 4096;
+};
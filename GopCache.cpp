@@ -0,0 +1,363 @@
+#include "GopCache.h"
+
+#include <iostream>
+
+void GopCache::Gop::clear()
+{
+	for (AVFrame*& frame : frames)
+	{
+		av_frame_free(&frame);
+	}
+	frames.clear();
+	startPts = AV_NOPTS_VALUE;
+	endPts = AV_NOPTS_VALUE;
+	bytes = 0;
+	bValid = false;
+}
+
+GopCache::GopCache()
+{
+	m_mutex = SDL_CreateMutex();
+	m_cond = SDL_CreateCond();
+}
+
+GopCache::~GopCache()
+{
+	close();
+	SDL_DestroyCond(m_cond);
+	SDL_DestroyMutex(m_mutex);
+}
+
+bool GopCache::open(const std::string& filePath, int streamIndex, int threadCount, ConvertFunc convert)
+{
+	close();
+	int ret = avformat_open_input(&m_fmtCtx, filePath.c_str(), nullptr, nullptr);
+	if (ret >= 0)
+	{
+		ret = avformat_find_stream_info(m_fmtCtx, nullptr);
+	}
+	if (ret < 0 || streamIndex < 0 || streamIndex >= (int)m_fmtCtx->nb_streams)
+	{
+		avformat_close_input(&m_fmtCtx);
+		return false;
+	}
+	m_streamIndex = streamIndex;
+	for (unsigned int i = 0; i < m_fmtCtx->nb_streams; ++i)
+	{
+		m_fmtCtx->streams[i]->discard = (int)i == m_streamIndex ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+	}
+	AVStream* stream = m_fmtCtx->streams[m_streamIndex];
+	const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+	m_codecCtx = codec ? avcodec_alloc_context3(codec) : nullptr;
+	if (!m_codecCtx)
+	{
+		avformat_close_input(&m_fmtCtx);
+		return false;
+	}
+	avcodec_parameters_to_context(m_codecCtx, stream->codecpar);
+	m_codecCtx->pkt_timebase = stream->time_base;
+	m_codecCtx->thread_count = threadCount;
+	if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
+	{
+		avcodec_free_context(&m_codecCtx);
+		avformat_close_input(&m_fmtCtx);
+		return false;
+	}
+	m_timeBase = stream->time_base;
+	m_convert = convert;
+	m_pkt = av_packet_alloc();
+	m_frame = av_frame_alloc();
+	m_bAbort = false;
+	m_thread = SDL_CreateThread(decodeThread, "gopCache", this);
+	return true;
+}
+
+void GopCache::close()
+{
+	SDL_LockMutex(m_mutex);
+	m_bAbort = true;
+	SDL_CondBroadcast(m_cond);
+	SDL_UnlockMutex(m_mutex);
+	SDL_WaitThread(m_thread, NULL);
+	m_thread = nullptr;
+
+	// frameBefore/frameAfter߳Уabortܿ췵
+	SDL_LockMutex(m_mutex);
+	m_cur.clear();
+	m_ready.clear();
+	m_bRequest = false;
+	m_bDecoding = false;
+	SDL_UnlockMutex(m_mutex);
+	av_packet_free(&m_pkt);
+	av_frame_free(&m_frame);
+	avcodec_free_context(&m_codecCtx);
+	avformat_close_input(&m_fmtCtx);
+	if (m_prefetchHits + m_prefetchMisses > 0)
+	{
+		std::cout << "[gop cache]: prefetch hit " << m_prefetchHits << " miss " << m_prefetchMisses << std::endl;
+	}
+	m_prefetchHits = 0;
+	m_prefetchMisses = 0;
+}
+
+void GopCache::abort()
+{
+	SDL_LockMutex(m_mutex);
+	m_bAbort = true;
+	SDL_CondBroadcast(m_cond);
+	SDL_UnlockMutex(m_mutex);
+}
+
+AVFrame* GopCache::frameBefore(int64_t pts)
+{
+	SDL_LockMutex(m_mutex);
+	AVFrame* frame = findBefore(m_cur, pts);
+	if (!frame)
+	{
+		frame = findBefore(m_ready, pts);
+		if (frame)
+		{
+			m_prefetchHits++;
+			std::swap(m_cur, m_ready);
+			m_ready.clear();
+		}
+		else
+		{
+			m_prefetchMisses++;
+			Request request;
+			request.target = pts - 1;
+			request.bBackward = true;
+			frame = waitFrame(request, pts);
+		}
+	}
+	// ʾǰGOPͬʱ֮ǰһ
+	if (m_cur.bValid && !m_cur.frames.empty())
+	{
+		Request request;
+		request.target = m_cur.startPts - 1;
+		request.bBackward = true;
+		prefetch(request);
+	}
+	SDL_UnlockMutex(m_mutex);
+	return frame;
+}
+
+AVFrame* GopCache::frameAfter(int64_t pts)
+{
+	SDL_LockMutex(m_mutex);
+	AVFrame* frame = findAfter(m_cur, pts);
+	if (!frame)
+	{
+		frame = findAfter(m_ready, pts);
+		if (frame)
+		{
+			std::swap(m_cur, m_ready);
+			m_ready.clear();
+		}
+		else
+		{
+			Request request;
+			request.target = pts + 1;
+			request.bBackward = false;
+			frame = waitFrame(request, pts);
+		}
+	}
+	SDL_UnlockMutex(m_mutex);
+	return frame;
+}
+
+AVFrame* GopCache::findBefore(const Gop& gop, int64_t pts)
+{
+	// [startPts, endPts)ڵ֡ڻУpts֮ǰڵ֡ſ
+	if (!gop.bValid || gop.frames.empty() || pts <= gop.startPts || pts > gop.endPts)
+	{
+		return nullptr;
+	}
+	for (auto it = gop.frames.rbegin(); it != gop.frames.rend(); ++it)
+	{
+		if ((*it)->pts < pts)
+		{
+			return av_frame_clone(*it);
+		}
+	}
+	return nullptr;
+}
+
+AVFrame* GopCache::findAfter(const Gop& gop, int64_t pts)
+{
+	if (!gop.bValid || gop.frames.empty() || pts + 1 < gop.startPts || pts >= gop.endPts)
+	{
+		return nullptr;
+	}
+	for (AVFrame* frame : gop.frames)
+	{
+		if (frame->pts > pts)
+		{
+			return av_frame_clone(frame);
+		}
+	}
+	return nullptr;
+}
+
+// ǰѼȴ߳request
+AVFrame* GopCache::waitFrame(const Request& request, int64_t pts)
+{
+	while (!m_bAbort)
+	{
+		if (m_ready.bValid && m_ready.request == request)
+		{
+			std::swap(m_cur, m_ready);
+			m_ready.clear();
+			// Ȼû˵ѵͷβ
+			return request.bBackward ? findBefore(m_cur, pts) : findAfter(m_cur, pts);
+		}
+		bool bPending = (m_bRequest && m_request == request) || (m_bDecoding && m_decodingRequest == request);
+		if (!bPending)
+		{
+			m_request = request;
+			m_bRequest = true;
+			SDL_CondBroadcast(m_cond);
+		}
+		SDL_CondWait(m_cond, m_mutex);
+	}
+	return nullptr;
+}
+
+// ǰѼ
+void GopCache::prefetch(const Request& request)
+{
+	bool bDone = m_ready.bValid && m_ready.request == request;
+	bool bPending = (m_bRequest && m_request == request) || (m_bDecoding && m_decodingRequest == request);
+	if (!bDone && !bPending)
+	{
+		m_request = request;
+		m_bRequest = true;
+		SDL_CondBroadcast(m_cond);
+	}
+}
+
+int GopCache::decodeThread(void* data)
+{
+	GopCache* obj = static_cast<GopCache*>(data);
+	SDL_LockMutex(obj->m_mutex);
+	while (!obj->m_bAbort)
+	{
+		if (!obj->m_bRequest)
+		{
+			SDL_CondWait(obj->m_cond, obj->m_mutex);
+			continue;
+		}
+		Request request = obj->m_request;
+		obj->m_bRequest = false;
+		obj->m_bDecoding = true;
+		obj->m_decodingRequest = request;
+		SDL_UnlockMutex(obj->m_mutex);
+
+		Gop gop;
+		gop.request = request;
+		obj->decodeGop(request, &gop);
+
+		SDL_LockMutex(obj->m_mutex);
+		obj->m_bDecoding = false;
+		obj->m_ready.clear();
+		obj->m_ready = std::move(gop);
+		SDL_CondBroadcast(obj->m_cond);
+	}
+	SDL_UnlockMutex(obj->m_mutex);
+	return 0;
+}
+
+void GopCache::decodeGop(const Request& request, Gop* gop)
+{
+	int64_t target = av_rescale_q(request.target, { 1, AV_TIME_BASE }, m_timeBase);
+	// Ŀ֮ǰĹؼ֡Ŀڵһؼ֮֡ǰʱȡһ
+	if (avformat_seek_file(m_fmtCtx, m_streamIndex, INT64_MIN, target, target, 0) < 0)
+	{
+		avformat_seek_file(m_fmtCtx, m_streamIndex, INT64_MIN, target, INT64_MAX, 0);
+	}
+	avcodec_flush_buffers(m_codecCtx);
+
+	bool bDone = false;
+	while (!bDone && !m_bAbort)
+	{
+		int ret = av_read_frame(m_fmtCtx, m_pkt);
+		if (ret < 0)
+		{
+			// ꣬ȡʣ֡
+			avcodec_send_packet(m_codecCtx, nullptr);
+			receiveFrames(request, gop, &bDone);
+			break;
+		}
+		if (m_pkt->stream_index == m_streamIndex)
+		{
+			avcodec_send_packet(m_codecCtx, m_pkt);
+		}
+		av_packet_unref(m_pkt);
+		receiveFrames(request, gop, &bDone);
+	}
+
+	gop->bValid = true;
+	if (request.bBackward)
+	{
+		gop->endPts = request.target + 1;
+		gop->startPts = gop->frames.empty() ? gop->endPts : gop->frames.front()->pts;
+	}
+	else
+	{
+		gop->startPts = request.target;
+		gop->endPts = gop->frames.empty() ? gop->startPts : gop->frames.back()->pts + 1;
+	}
+}
+
+void GopCache::receiveFrames(const Request& request, Gop* gop, bool* bDone)
+{
+	while (avcodec_receive_frame(m_codecCtx, m_frame) == 0)
+	{
+		int64_t pts = m_frame->best_effort_timestamp;
+		if (*bDone || pts == AV_NOPTS_VALUE)
+		{
+			av_frame_unref(m_frame);
+			continue;
+		}
+		pts = av_rescale_q(pts, m_timeBase, { 1, AV_TIME_BASE });
+		// 򣺳Ŀ˵GOPѽꣻĿ֮ǰ֡
+		if (request.bBackward ? pts > request.target : pts < request.target)
+		{
+			*bDone = request.bBackward;
+			av_frame_unref(m_frame);
+			continue;
+		}
+		// 򣺵һؼ֡򳬳޽
+		if (!request.bBackward && !gop->frames.empty() && (m_frame->key_frame || gop->bytes >= MAX_GOP_BYTES))
+		{
+			*bDone = true;
+			av_frame_unref(m_frame);
+			continue;
+		}
+		AVFrame* outFrame = m_convert(m_frame);
+		av_frame_unref(m_frame);
+		if (!outFrame)
+		{
+			continue;
+		}
+		outFrame->pts = pts;
+		size_t bytes = 0;
+		for (AVBufferRef* buf : outFrame->buf)
+		{
+			bytes += buf ? buf->size : 0;
+		}
+		gop->frames.push_back(outFrame);
+		gop->bytes += bytes;
+		// 򣺳޶֡ʾʱٴӹؼ֡һ
+		while (request.bBackward && gop->bytes > MAX_GOP_BYTES && gop->frames.size() > 1)
+		{
+			AVFrame* oldest = gop->frames.front();
+			for (AVBufferRef* buf : oldest->buf)
+			{
+				gop->bytes -= buf ? buf->size : 0;
+			}
+			av_frame_free(&oldest);
+			gop->frames.erase(gop->frames.begin());
+		}
+	}
+}
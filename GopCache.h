@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <functional>
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+#include "libavutil/avutil.h"
+#include "SDL2/SDL.h"
+#include <SDL2/SDL_thread.h>
+}
+
+// 򲥷ź֡õGOP뻺棬AVFormatContextֻԼĽ߳з
+// ÿνһGOP֡convertתʽ󱣴ãʱԤǰһGOP
+// ptsΪAV_TIME_BASE
+class GopCache
+{
+public:
+	typedef std::function<AVFrame*(AVFrame*)> ConvertFunc; // ڽ̵߳ã֡nullptrʾ
+
+	GopCache();
+	~GopCache();
+
+	bool open(const std::string& filePath, int streamIndex, int threadCount, ConvertFunc convert);
+	void close();
+	void abort(); // õȴеframeBefore/frameAfterأ֮closeͷ
+	bool isOpen() const
+	{
+		return m_thread != nullptr;
+	}
+
+	// pts֮ǰ/֮ڵһ֡ڻʱȴ룬ɵͷ
+	// û֡(ͷ)nullptr
+	AVFrame* frameBefore(int64_t pts);
+	AVFrame* frameAfter(int64_t pts);
+
+	int64_t prefetchHits() const // GOPʱǰһGOPԤ
+	{
+		return m_prefetchHits;
+	}
+	int64_t prefetchMisses() const
+	{
+		return m_prefetchMisses;
+	}
+
+private:
+	struct Request
+	{
+		int64_t target = AV_NOPTS_VALUE; // 򣺱pts<=target֡򣺱pts>=target֡
+		bool bBackward = true;
+		bool operator==(const Request& other) const
+		{
+			return target == other.target && bBackward == other.bBackward;
+		}
+	};
+	struct Gop
+	{
+		Request request;
+		std::vector<AVFrame*> frames; // pts
+		int64_t startPts = AV_NOPTS_VALUE; // [startPts, endPts)
+		int64_t endPts = AV_NOPTS_VALUE;
+		size_t bytes = 0;
+		bool bValid = false;
+		void clear();
+	};
+
+	static int decodeThread(void* data);
+	void decodeGop(const Request& request, Gop* gop);
+	void receiveFrames(const Request& request, Gop* gop, bool* bDone);
+	AVFrame* findBefore(const Gop& gop, int64_t pts);
+	AVFrame* findAfter(const Gop& gop, int64_t pts);
+	AVFrame* waitFrame(const Request& request, int64_t pts);
+	void prefetch(const Request& request);
+
+	AVFormatContext* m_fmtCtx = nullptr;
+	AVCodecContext* m_codecCtx = nullptr;
+	AVPacket* m_pkt = nullptr;
+	AVFrame* m_frame = nullptr;
+	int m_streamIndex = -1;
+	AVRational m_timeBase = { 1, AV_TIME_BASE };
+	ConvertFunc m_convert;
+
+	SDL_Thread* m_thread = nullptr;
+	SDL_mutex* m_mutex = nullptr; // ³Ա
+	SDL_cond* m_cond = nullptr; // GOPʱ㲥
+	Gop m_cur; // ʾGOP
+	Gop m_ready; // ߳ɵGOP
+	Request m_request; // ȴ
+	Request m_decodingRequest;
+	bool m_bRequest = false;
+	bool m_bDecoding = false;
+	std::atomic<bool> m_bAbort{ false }; // в
+
+	std::atomic<int64_t> m_prefetchHits{ 0 };
+	std::atomic<int64_t> m_prefetchMisses{ 0 };
+
+	const size_t MAX_GOP_BYTES = 256 * 1024 * 1024; // GOPޣǰԤһ
+};
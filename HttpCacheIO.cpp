@@ -0,0 +1,416 @@
+#include "HttpCacheIO.h"
+
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <functional>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winioctl.h>
+#include <io.h>
+#endif
+
+static int seekFile(FILE* fp, int64_t offset)
+{
+#ifdef _WIN32
+	return _fseeki64(fp, offset, SEEK_SET);
+#else
+	return fseeko(fp, offset, SEEK_SET);
+#endif
+}
+
+// NTFSдļĬϲϡ裬мδдĲҲռ̣ļϵͳĬϡ
+static void setSparse(FILE* fp)
+{
+#ifdef _WIN32
+	HANDLE file = (HANDLE)_get_osfhandle(_fileno(fp));
+	DWORD bytes = 0;
+	if (file == INVALID_HANDLE_VALUE || !DeviceIoControl(file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &bytes, nullptr))
+	{
+		std::cout << "[http cache]: FSCTL_SET_SPARSE failed " << GetLastError() << std::endl;
+	}
+#else
+	(void)fp;
+#endif
+}
+
+static int64_t countBits(const std::vector<uint8_t>& bitmap)
+{
+	int64_t count = 0;
+	for (uint8_t bits : bitmap)
+	{
+		for (; bits; bits &= bits - 1)
+		{
+			++count;
+		}
+	}
+	return count;
+}
+
+HttpCacheIO::~HttpCacheIO()
+{
+	close();
+}
+
+bool HttpCacheIO::isHttpUrl(const std::string& url)
+{
+	return url.compare(0, 7, "http://") == 0 || url.compare(0, 8, "https://") == 0;
+}
+
+bool HttpCacheIO::open(const std::string& url, const std::string& cacheDir, int64_t budget)
+{
+	close();
+	m_bAbort = false;
+	AVIOInterruptCB interrupt = { interruptCallback, this };
+	if (avio_open2(&m_src, url.c_str(), AVIO_FLAG_READ, &interrupt, nullptr) < 0)
+	{
+		return false;
+	}
+	m_size = avio_size(m_src);
+	if (m_size <= 0 || !(m_src->seekable & AVIO_SEEKABLE_NORMAL) || !QDir().mkpath(QString::fromStdString(cacheDir)))
+	{
+		avio_closep(&m_src);
+		return false;
+	}
+	// ffmpeghttpЭ鲻ETagurl+С滻ͬСļʱֶ建
+	char key[64];
+	snprintf(key, sizeof(key), "%016llx_%lld", (unsigned long long)std::hash<std::string>()(url), (long long)m_size);
+	m_url = url;
+	m_cacheDir = cacheDir;
+	m_key = key;
+	m_budget = budget;
+	m_bitmap.assign((size_t)((m_size + CHUNK_SIZE - 1) / CHUNK_SIZE + 7) / 8, 0);
+
+	std::string dataPath = m_cacheDir + "/" + m_key + ".data";
+	if (loadMap())
+	{
+		m_dataFp = fopen(dataPath.c_str(), "r+b");
+	}
+	if (!m_dataFp)
+	{
+		// λͼЧļʧĿؽ
+		if (m_mapFp)
+		{
+			fclose(m_mapFp);
+			m_mapFp = nullptr;
+		}
+		if (createMap())
+		{
+			m_dataFp = fopen(dataPath.c_str(), "w+b");
+		}
+	}
+	if (m_dataFp)
+	{
+		setSparse(m_dataFp);
+	}
+	else
+	{
+		m_bFull = true; // Ŀ¼дֻ͸
+	}
+
+	m_otherBytes = 0;
+	QDir dir(QString::fromStdString(m_cacheDir));
+	for (const QFileInfo& info : dir.entryInfoList(QStringList() << "*.map", QDir::Files))
+	{
+		if (info.completeBaseName().toStdString() != m_key)
+		{
+			m_otherBytes += entryBytes(info.absoluteFilePath().toStdString());
+		}
+	}
+	evict(0);
+
+	m_chunkBuf = (uint8_t*)av_malloc(CHUNK_SIZE);
+	m_bufIndex = -1;
+	m_hitIndex = -1;
+	m_pos = 0;
+	m_srcPos = 0;
+	uint8_t* buffer = (uint8_t*)av_malloc(IO_BUFFER_SIZE);
+	m_avioCtx = avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this, readPacket, nullptr, seek);
+	std::cout << "[http cache]: " << m_cachedBytes / (1024 * 1024) << " of " << m_size / (1024 * 1024)
+		<< " MB cached, others " << m_otherBytes / (1024 * 1024) << " MB" << std::endl;
+	return true;
+}
+
+void HttpCacheIO::close()
+{
+	if (m_avioCtx)
+	{
+		av_freep(&m_avioCtx->buffer);
+		avio_context_free(&m_avioCtx);
+		std::cout << "[http cache]: hit " << m_hits << " miss " << m_misses << " saved "
+			<< m_bytesSaved / (1024 * 1024) << " MB" << std::endl;
+	}
+	avio_closep(&m_src);
+	av_freep(&m_chunkBuf);
+	if (m_dataFp)
+	{
+		fclose(m_dataFp);
+		m_dataFp = nullptr;
+	}
+	if (m_mapFp)
+	{
+		fclose(m_mapFp);
+		m_mapFp = nullptr;
+	}
+	m_bitmap.clear();
+	m_cachedBytes = 0;
+	m_otherBytes = 0;
+	m_bFull = false;
+	m_hits = 0;
+	m_misses = 0;
+	m_bytesSaved = 0;
+}
+
+void HttpCacheIO::abort()
+{
+	m_bAbort = true;
+}
+
+int HttpCacheIO::interruptCallback(void* data)
+{
+	return static_cast<HttpCacheIO*>(data)->m_bAbort.load();
+}
+
+bool HttpCacheIO::loadMap()
+{
+	std::string mapPath = m_cacheDir + "/" + m_key + ".map";
+	FILE* fp = fopen(mapPath.c_str(), "r+b");
+	if (!fp)
+	{
+		return false;
+	}
+	MapHeader header;
+	bool bOk = fread(&header, sizeof(header), 1, fp) == 1 &&
+		header.magic == MAP_MAGIC && header.version == MAP_VERSION && header.size == m_size &&
+		header.chunkSize == CHUNK_SIZE && header.urlLength == (int32_t)m_url.size();
+	if (bOk)
+	{
+		std::string url(m_url.size(), '\0');
+		bOk = fread(&url[0], 1, url.size(), fp) == url.size() && url == m_url &&
+			fread(m_bitmap.data(), 1, m_bitmap.size(), fp) == m_bitmap.size();
+	}
+	if (!bOk)
+	{
+		fclose(fp);
+		std::fill(m_bitmap.begin(), m_bitmap.end(), 0);
+		return false;
+	}
+	// дͷ޸ʱ䣬̭ʱݴжʹ
+	seekFile(fp, 0);
+	fwrite(&header, sizeof(header), 1, fp);
+	fflush(fp);
+	m_mapFp = fp;
+	m_cachedBytes = countBits(m_bitmap) * CHUNK_SIZE;
+	return true;
+}
+
+bool HttpCacheIO::createMap()
+{
+	std::string mapPath = m_cacheDir + "/" + m_key + ".map";
+	FILE* fp = fopen(mapPath.c_str(), "w+b");
+	if (!fp)
+	{
+		return false;
+	}
+	MapHeader header;
+	header.magic = MAP_MAGIC;
+	header.version = MAP_VERSION;
+	header.size = m_size;
+	header.chunkSize = CHUNK_SIZE;
+	header.urlLength = (int32_t)m_url.size();
+	std::fill(m_bitmap.begin(), m_bitmap.end(), 0);
+	bool bOk = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		fwrite(m_url.data(), 1, m_url.size(), fp) == m_url.size() &&
+		fwrite(m_bitmap.data(), 1, m_bitmap.size(), fp) == m_bitmap.size() &&
+		fflush(fp) == 0;
+	if (!bOk)
+	{
+		fclose(fp);
+		remove(mapPath.c_str());
+		return false;
+	}
+	m_mapFp = fp;
+	m_cachedBytes = 0;
+	return true;
+}
+
+int64_t HttpCacheIO::entryBytes(const std::string& mapPath)
+{
+	FILE* fp = fopen(mapPath.c_str(), "rb");
+	if (!fp)
+	{
+		return 0;
+	}
+	MapHeader header;
+	int64_t bytes = 0;
+	if (fread(&header, sizeof(header), 1, fp) == 1 && header.chunkSize > 0 && header.size > 0 &&
+		seekFile(fp, sizeof(header) + header.urlLength) == 0)
+	{
+		std::vector<uint8_t> bitmap((size_t)((header.size + header.chunkSize - 1) / header.chunkSize + 7) / 8);
+		if (fread(bitmap.data(), 1, bitmap.size(), fp) == bitmap.size())
+		{
+			bytes = countBits(bitmap) * header.chunkSize;
+		}
+	}
+	fclose(fp);
+	return bytes;
+}
+
+void HttpCacheIO::evict(int64_t needBytes)
+{
+	// δõǰ
+	QDir dir(QString::fromStdString(m_cacheDir));
+	QFileInfoList entries = dir.entryInfoList(QStringList() << "*.map", QDir::Files, QDir::Time | QDir::Reversed);
+	for (const QFileInfo& info : entries)
+	{
+		if (m_cachedBytes + m_otherBytes + needBytes <= m_budget)
+		{
+			break;
+		}
+		if (info.completeBaseName().toStdString() == m_key)
+		{
+			continue;
+		}
+		int64_t bytes = entryBytes(info.absoluteFilePath().toStdString());
+		QFile::remove(dir.filePath(info.completeBaseName() + ".data"));
+		QFile::remove(info.absoluteFilePath());
+		m_otherBytes = FFMAX(m_otherBytes - bytes, 0);
+		std::cout << "[http cache]: evict " << info.completeBaseName().toStdString() << " "
+			<< bytes / (1024 * 1024) << " MB" << std::endl;
+	}
+}
+
+bool HttpCacheIO::fetchChunk(int64_t index)
+{
+	int64_t start = index * CHUNK_SIZE;
+	int want = (int)FFMIN((int64_t)CHUNK_SIZE, m_size - start);
+	// ˳ȡʱͬһֻԾʱ·Range
+	if (m_srcPos != start)
+	{
+		if (avio_seek(m_src, start, SEEK_SET) < 0)
+		{
+			return false;
+		}
+		m_srcPos = start;
+	}
+	m_bufIndex = -1;
+	int size = 0;
+	while (size < want)
+	{
+		int ret = avio_read(m_src, m_chunkBuf + size, want - size);
+		if (ret <= 0)
+		{
+			break;
+		}
+		size += ret;
+	}
+	m_srcPos += size;
+	if (size < want)
+	{
+		m_srcPos = -1; // ״̬δ֪´
+		return false;
+	}
+	m_bufIndex = index;
+	storeChunk(index, size);
+	return true;
+}
+
+void HttpCacheIO::storeChunk(int64_t index, int size)
+{
+	if (m_bFull)
+	{
+		return;
+	}
+	if (m_cachedBytes + m_otherBytes + size > m_budget)
+	{
+		evict(size);
+		if (m_cachedBytes + m_otherBytes + size > m_budget)
+		{
+			m_bFull = true;
+			std::cout << "[http cache]: budget full, " << m_cachedBytes / (1024 * 1024) << " MB cached" << std::endl;
+			return;
+		}
+	}
+	// дٱλͼ;˳ʱඪһ
+	if (seekFile(m_dataFp, index * CHUNK_SIZE) != 0 || fwrite(m_chunkBuf, 1, size, m_dataFp) != (size_t)size ||
+		fflush(m_dataFp) != 0)
+	{
+		return;
+	}
+	m_bitmap[index / 8] |= 1 << (index % 8);
+	seekFile(m_mapFp, sizeof(MapHeader) + m_url.size() + index / 8);
+	fwrite(&m_bitmap[index / 8], 1, 1, m_mapFp);
+	fflush(m_mapFp);
+	m_cachedBytes += size;
+}
+
+int HttpCacheIO::readPacket(void* opaque, uint8_t* buf, int bufSize)
+{
+	HttpCacheIO* obj = static_cast<HttpCacheIO*>(opaque);
+	if (obj->m_pos >= obj->m_size)
+	{
+		return AVERROR_EOF;
+	}
+	int64_t index = obj->m_pos / CHUNK_SIZE;
+	int offset = (int)(obj->m_pos - index * CHUNK_SIZE);
+	int len = (int)FFMIN((int64_t)bufSize, FFMIN((int64_t)CHUNK_SIZE, obj->m_size - index * CHUNK_SIZE) - offset);
+	if (obj->m_bufIndex == index)
+	{
+		memcpy(buf, obj->m_chunkBuf + offset, len);
+	}
+	else if (obj->hasChunk(index) && seekFile(obj->m_dataFp, obj->m_pos) == 0 &&
+		fread(buf, 1, len, obj->m_dataFp) == (size_t)len)
+	{
+		// missһͬһֶζֻһ
+		if (obj->m_hitIndex != index)
+		{
+			obj->m_hitIndex = index;
+			obj->m_hits++;
+		}
+		obj->m_bytesSaved += len;
+	}
+	else
+	{
+		obj->m_misses++;
+		if (!obj->fetchChunk(index))
+		{
+			return obj->m_bAbort ? AVERROR_EXIT : AVERROR(EIO);
+		}
+		memcpy(buf, obj->m_chunkBuf + offset, len);
+	}
+	obj->m_pos += len;
+	return len;
+}
+
+int64_t HttpCacheIO::seek(void* opaque, int64_t offset, int whence)
+{
+	HttpCacheIO* obj = static_cast<HttpCacheIO*>(opaque);
+	int64_t pos = 0;
+	switch (whence & ~AVSEEK_FORCE)
+	{
+	case AVSEEK_SIZE:
+		return obj->m_size;
+	case SEEK_SET:
+		pos = offset;
+		break;
+	case SEEK_CUR:
+		pos = obj->m_pos + offset;
+		break;
+	case SEEK_END:
+		pos = obj->m_size + offset;
+		break;
+	default:
+		return AVERROR(EINVAL);
+	}
+	if (pos < 0 || pos > obj->m_size)
+	{
+		return AVERROR(EINVAL);
+	}
+	// ֻƶλãδĿʱ
+	obj->m_pos = pos;
+	return pos;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+#include "libavformat/avio.h"
+#include "libavutil/avutil.h"
+}
+
+// http(s)صĴ̻AVIOContextCHUNK_SIZEֿȡдϡļ
+// ÿurl+ļСһĿ<key>.dataݣ<key>.mapurlѻλͼ
+// ܴСԤʱ.map޸ʱ̭δõĿ
+class HttpCacheIO
+{
+public:
+	HttpCacheIO() = default;
+	~HttpCacheIO();
+
+	static bool isHttpUrl(const std::string& url);
+
+	// ֧RangeСδ֪ʱfalseffmpegֱӴ
+	bool open(const std::string& url, const std::string& cacheDir, int64_t budget);
+	void close();
+	void abort(); // жеȡcloseStreamȴȡ֮߳ǰ
+	AVIOContext* avioContext()
+	{
+		return m_avioCtx;
+	}
+
+	int64_t hits() const // Ӵ̶ȡĿ
+	{
+		return m_hits;
+	}
+	int64_t misses() const // صĿ
+	{
+		return m_misses;
+	}
+	int64_t bytesSaved() const // Ӵ̶ȡʡµ
+	{
+		return m_bytesSaved;
+	}
+
+	static const int CHUNK_SIZE = 1024 * 1024;
+
+private:
+	struct MapHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		int64_t size; // ԴļС
+		int32_t chunkSize;
+		int32_t urlLength; // urlٽλͼ
+	};
+
+	static int readPacket(void* opaque, uint8_t* buf, int bufSize);
+	static int64_t seek(void* opaque, int64_t offset, int whence);
+	static int interruptCallback(void* data);
+	static int64_t entryBytes(const std::string& mapPath); // Ŀѻֽ
+	bool loadMap();
+	bool createMap();
+	bool fetchChunk(int64_t index);
+	void storeChunk(int64_t index, int size);
+	void evict(int64_t needBytes);
+	bool hasChunk(int64_t index) const
+	{
+		return (m_bitmap[index / 8] >> (index % 8)) & 1;
+	}
+
+	std::string m_url;
+	std::string m_cacheDir;
+	std::string m_key;
+	AVIOContext* m_src = nullptr; // 
+	AVIOContext* m_avioCtx = nullptr;
+	FILE* m_dataFp = nullptr;
+	FILE* m_mapFp = nullptr;
+	std::vector<uint8_t> m_bitmap;
+	uint8_t* m_chunkBuf = nullptr; // صĿ飬Ԥ㲻дʱҲ
+	int64_t m_bufIndex = -1;
+	int64_t m_hitIndex = -1; // Ӵ̶ȡĿ飬hits
+	int64_t m_size = 0;
+	int64_t m_pos = 0;
+	int64_t m_srcPos = 0; // ӵĶȡλãʱ
+	int64_t m_budget = 0;
+	int64_t m_cachedBytes = 0; // Ŀ
+	int64_t m_otherBytes = 0; // Ŀ
+	bool m_bFull = false; // ̭ĿԳԤ㣬д
+	std::atomic<bool> m_bAbort{ false };
+
+	std::atomic<int64_t> m_hits{ 0 };
+	std::atomic<int64_t> m_misses{ 0 };
+	std::atomic<int64_t> m_bytesSaved{ 0 };
+
+	const uint32_t MAP_MAGIC = 0x4d434850; // "PHCM"
+	const uint32_t MAP_VERSION = 1;
+	const int IO_BUFFER_SIZE = 256 * 1024;
+};
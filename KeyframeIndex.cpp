@@ -0,0 +1,231 @@
+#include "KeyframeIndex.h"
+
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	// ·utf-8խַstat/fopenشҳͣASCII·򲻿
+	std::wstring toWide(const std::string& path)
+	{
+		int len = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+		std::wstring wide(FFMAX(len, 1), L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], len);
+		return wide;
+	}
+#endif
+
+	FILE* openFile(const std::string& path, const char* mode)
+	{
+#ifdef _WIN32
+		std::wstring wideMode(mode, mode + strlen(mode));
+		return _wfopen(toWide(path).c_str(), wideMode.c_str());
+#else
+		return fopen(path.c_str(), mode);
+#endif
+	}
+
+	void removeFile(const std::string& path)
+	{
+#ifdef _WIN32
+		_wremove(toWide(path).c_str());
+#else
+		remove(path.c_str());
+#endif
+	}
+
+	struct SidecarHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		int64_t fileSize; // ýļһʱ·ļ
+		int64_t mtime;
+		int32_t streamIndex;
+		uint32_t count;
+	};
+}
+
+KeyframeIndex::~KeyframeIndex()
+{
+	close();
+}
+
+void KeyframeIndex::open(const std::string& filePath, int streamIndex)
+{
+	close();
+	m_filePath = filePath;
+	m_sidecarPath = filePath + ".kfidx";
+	m_streamIndex = streamIndex;
+	if (load())
+	{
+		m_bReady.store(true, std::memory_order_release);
+		std::cout << "[keyframe index]: " << m_entries.size() << " keyframes loaded from " << m_sidecarPath << std::endl;
+		return;
+	}
+	m_thread = SDL_CreateThread(indexThread, "keyframeIndex", this);
+}
+
+void KeyframeIndex::close()
+{
+	m_bAbort = true;
+	SDL_WaitThread(m_thread, NULL);
+	m_thread = nullptr;
+	m_bAbort = false;
+	m_bReady = false;
+	m_entries.clear();
+}
+
+bool KeyframeIndex::find(int64_t target, Entry* entry) const
+{
+	if (!isReady() || m_entries.empty())
+	{
+		return false;
+	}
+	auto it = std::upper_bound(m_entries.begin(), m_entries.end(), target,
+		[](int64_t pts, const Entry& e) { return pts < e.pts; });
+	if (it == m_entries.begin())
+	{
+		return false;
+	}
+	*entry = *(it - 1);
+	return true;
+}
+
+int KeyframeIndex::indexThread(void* data)
+{
+	KeyframeIndex* obj = static_cast<KeyframeIndex*>(data);
+	// Ͳ߳CPU
+	SDL_SetThreadPriority(SDL_THREAD_PRIORITY_LOW);
+	int64_t start = av_gettime_relative();
+	if (obj->scan())
+	{
+		obj->save();
+		obj->m_bReady.store(true, std::memory_order_release);
+		std::cout << "[keyframe index]: " << obj->m_entries.size() << " keyframes in "
+			<< (av_gettime_relative() - start) / 1000 << " ms" << std::endl;
+	}
+	return 0;
+}
+
+int KeyframeIndex::interruptCallback(void* data)
+{
+	return static_cast<KeyframeIndex*>(data)->m_bAbort.load();
+}
+
+bool KeyframeIndex::scan()
+{
+	AVFormatContext* fmtCtx = avformat_alloc_context();
+	fmtCtx->interrupt_callback.callback = interruptCallback;
+	fmtCtx->interrupt_callback.opaque = this;
+	int ret = avformat_open_input(&fmtCtx, m_filePath.c_str(), nullptr, nullptr);
+	if (ret < 0 || m_streamIndex >= (int)fmtCtx->nb_streams)
+	{
+		avformat_close_input(&fmtCtx);
+		return false;
+	}
+	// ֻҪλãİ
+	for (unsigned int i = 0; i < fmtCtx->nb_streams; ++i)
+	{
+		fmtCtx->streams[i]->discard = (int)i == m_streamIndex ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+	}
+	AVRational tb = fmtCtx->streams[m_streamIndex]->time_base;
+	AVPacket* pkt = av_packet_alloc();
+	while (!m_bAbort && (ret = av_read_frame(fmtCtx, pkt)) >= 0)
+	{
+		int64_t pts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+		if (pkt->stream_index == m_streamIndex && (pkt->flags & AV_PKT_FLAG_KEY) && pkt->pos >= 0 && pts != AV_NOPTS_VALUE)
+		{
+			Entry entry = { av_rescale_q(pts, tb, { 1, AV_TIME_BASE }), pkt->pos, pkt->size, 0 };
+			m_entries.push_back(entry);
+		}
+		av_packet_unref(pkt);
+	}
+	av_packet_free(&pkt);
+	avformat_close_input(&fmtCtx);
+	if (m_bAbort || ret != AVERROR_EOF)
+	{
+		m_entries.clear();
+		return false;
+	}
+	std::stable_sort(m_entries.begin(), m_entries.end(),
+		[](const Entry& a, const Entry& b) { return a.pts < b.pts; });
+	m_entries.shrink_to_fit();
+	return true;
+}
+
+bool KeyframeIndex::fileStat(int64_t* fileSize, int64_t* mtime)
+{
+#ifdef _WIN32
+	struct _stat64 st;
+	if (_wstat64(toWide(m_filePath).c_str(), &st) != 0)
+#else
+	struct stat st;
+	if (stat(m_filePath.c_str(), &st) != 0)
+#endif
+	{
+		return false; // ûбļ
+	}
+	*fileSize = (int64_t)st.st_size;
+	*mtime = (int64_t)st.st_mtime;
+	return true;
+}
+
+bool KeyframeIndex::load()
+{
+	SidecarHeader expect = { SIDECAR_MAGIC, SIDECAR_VERSION, 0, 0, m_streamIndex, 0 };
+	if (!fileStat(&expect.fileSize, &expect.mtime))
+	{
+		return false;
+	}
+	FILE* fp = openFile(m_sidecarPath, "rb");
+	if (!fp)
+	{
+		return false;
+	}
+	SidecarHeader header;
+	bool bOk = fread(&header, sizeof(header), 1, fp) == 1 &&
+		header.magic == expect.magic && header.version == expect.version &&
+		header.fileSize == expect.fileSize && header.mtime == expect.mtime &&
+		header.streamIndex == expect.streamIndex && header.count > 0;
+	if (bOk)
+	{
+		m_entries.resize(header.count);
+		bOk = fread(m_entries.data(), sizeof(Entry), header.count, fp) == header.count;
+	}
+	fclose(fp);
+	if (!bOk)
+	{
+		m_entries.clear();
+	}
+	return bOk;
+}
+
+void KeyframeIndex::save()
+{
+	SidecarHeader header = { SIDECAR_MAGIC, SIDECAR_VERSION, 0, 0, m_streamIndex, (uint32_t)m_entries.size() };
+	if (m_entries.empty() || !fileStat(&header.fileSize, &header.mtime))
+	{
+		return;
+	}
+	// Ŀ¼дʱֻڱβʹ
+	FILE* fp = openFile(m_sidecarPath, "wb");
+	if (!fp)
+	{
+		return;
+	}
+	bool bOk = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		fwrite(m_entries.data(), sizeof(Entry), m_entries.size(), fp) == m_entries.size();
+	fclose(fp);
+	if (!bOk)
+	{
+		removeFile(m_sidecarPath);
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+#include "libavutil/avutil.h"
+#include "libavutil/time.h"
+#include "SDL2/SDL.h"
+#include <SDL2/SDL_thread.h>
+}
+
+// Ƶؼ֡ȼ߳öAVFormatContextɨһļ
+// ɨɺд·ļ(ý·+".kfidx")´δֱӼ
+class KeyframeIndex
+{
+public:
+	struct Entry
+	{
+		int64_t pts; // AV_TIME_BASE
+		int64_t pos; // ļеֽƫ
+		int32_t size;
+		int32_t reserved;
+	};
+
+	KeyframeIndex() = default;
+	~KeyframeIndex();
+
+	// ȳԼ·ļʧʱɨ߳
+	void open(const std::string& filePath, int streamIndex);
+	void close(); // ֹɨ裬
+
+	bool isReady() const
+	{
+		return m_bReady.load(std::memory_order_acquire);
+	}
+	size_t size() const
+	{
+		return isReady() ? m_entries.size() : 0;
+	}
+	// ptstargetһؼ֡ûʱfalse
+	bool find(int64_t target, Entry* entry) const;
+
+private:
+	static int indexThread(void* data);
+	static int interruptCallback(void* data);
+	bool scan();
+	bool load();
+	void save();
+	bool fileStat(int64_t* fileSize, int64_t* mtime);
+
+	std::string m_filePath;
+	std::string m_sidecarPath;
+	int m_streamIndex = -1;
+	std::vector<Entry> m_entries; // ptsm_bReadyֻ֮
+	std::atomic<bool> m_bReady{ false };
+	std::atomic<bool> m_bAbort{ false };
+	SDL_Thread* m_thread = nullptr;
+
+	static const uint32_t SIDECAR_MAGIC = 0x49464b50; // "PKFI"
+	static const uint32_t SIDECAR_VERSION = 1;
+};
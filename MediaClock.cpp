@@ -0,0 +1,53 @@
+#include "MediaClock.h"
+
+MediaClock::MediaClock()
+{
+	m_mutex = SDL_CreateMutex();
+}
+
+MediaClock::~MediaClock()
+{
+	SDL_DestroyMutex(m_mutex);
+}
+
+void MediaClock::set(int64_t pts, int64_t time)
+{
+	SDL_LockMutex(m_mutex);
+	m_pts = pts;
+	m_time = time;
+	SDL_UnlockMutex(m_mutex);
+}
+
+int64_t MediaClock::get(int64_t time) const
+{
+	SDL_LockMutex(m_mutex);
+	int64_t clock = m_pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE : m_pts + (int64_t)((time - m_time) * m_speed);
+	SDL_UnlockMutex(m_mutex);
+	return clock;
+}
+
+bool MediaClock::isValid() const
+{
+	SDL_LockMutex(m_mutex);
+	bool bValid = m_pts != AV_NOPTS_VALUE;
+	SDL_UnlockMutex(m_mutex);
+	return bValid;
+}
+
+void MediaClock::reset()
+{
+	set(AV_NOPTS_VALUE, 0);
+}
+
+void MediaClock::setSpeed(double speed)
+{
+	int64_t now = av_gettime_relative();
+	SDL_LockMutex(m_mutex);
+	if (m_pts != AV_NOPTS_VALUE)
+	{
+		m_pts += (int64_t)((now - m_time) * m_speed);
+		m_time = now;
+	}
+	m_speed = speed;
+	SDL_UnlockMutex(m_mutex);
+}
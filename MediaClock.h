@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+extern "C"
+{
+#include "libavutil/avutil.h"
+#include "libavutil/time.h"
+#include "SDL2/SDL.h"
+}
+
+// ʱӣsetʱ¼pts͵ʱĵʱ̣֮ʵʾʱٶ
+// ʱ䵥λΪAV_TIME_BASE
+class MediaClock
+{
+public:
+	MediaClock();
+	~MediaClock();
+
+	void set(int64_t pts, int64_t time);
+	void set(int64_t pts)
+	{
+		set(pts, av_gettime_relative());
+	}
+	int64_t get(int64_t time) const; // δùAV_NOPTS_VALUE
+	int64_t get() const
+	{
+		return get(av_gettime_relative());
+	}
+	bool isValid() const;
+	void reset();
+	void setSpeed(double speed); // ԵǰʱΪ׼ıٶ
+
+private:
+	int64_t m_pts = AV_NOPTS_VALUE;
+	int64_t m_time = 0; // setʱav_gettime_relative
+	double m_speed = 1.0;
+	SDL_mutex* m_mutex = nullptr; // Ƶ߳дeventLoop
+};
@@ -0,0 +1,485 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+extern "C"
+{
+#include "libavcodec/avcodec.h"
+#include "libavutil/avutil.h"
+#include "libavutil/mem.h"
+#include "SDL2/SDL.h"
+}
+
+// ȡ롢֮߳ĶУֻSDLffmpeg
+
+const int CACHELINE_SIZE = 64;
+
+enum class QueueState
+{
+	NORMAL = 0,
+	EMPTY,
+	FULL,
+	LAST,
+};
+
+struct WaitEvent // ȴ/ѣûеȴʱnotify
+{
+	SDL_mutex* mutex = nullptr;
+	SDL_cond* cond = nullptr;
+	std::atomic<int> waiters{ 0 };
+	std::function<void()> listener; // ģʽ»ѹ񣬹ʱ
+	WaitEvent()
+	{
+		mutex = SDL_CreateMutex();
+		cond = SDL_CreateCond();
+	}
+	~WaitEvent()
+	{
+		SDL_DestroyCond(cond);
+		SDL_DestroyMutex(mutex);
+	}
+	// ״̬
+	void notify()
+	{
+		if (listener)
+		{
+			listener();
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_relaxed) > 0)
+		{
+			SDL_LockMutex(mutex);
+			SDL_CondBroadcast(cond);
+			SDL_UnlockMutex(mutex);
+		}
+	}
+	// ȴready()ΪtrueʱfalsetimeoutMs < 0ʱһֱȴ
+	template<class Pred>
+	bool wait(Pred ready, int timeoutMs = -1)
+	{
+		if (ready())
+		{
+			return true;
+		}
+		bool bReady = false;
+		SDL_LockMutex(mutex);
+		waiters.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		while (!(bReady = ready()))
+		{
+			if (timeoutMs < 0)
+			{
+				SDL_CondWait(cond, mutex);
+			}
+			else if (SDL_CondWaitTimeout(cond, mutex, timeoutMs) == SDL_MUTEX_TIMEDOUT)
+			{
+				bReady = ready();
+				break;
+			}
+		}
+		waiters.fetch_sub(1);
+		SDL_UnlockMutex(mutex);
+		return bReady;
+	}
+};
+
+struct AudioRingBuffer // زPCMֽڻζУߵ
+{
+	struct PtsMarker // дλoffsetݵʱ
+	{
+		size_t offset = 0;
+		int64_t pts = AV_NOPTS_VALUE; // AV_TIME_BASE
+		float speed = 1.0f; // ٺÿֽڶӦýʱ֮仯
+	};
+	static const int MARKER_COUNT = 256; // 2ݣ˶markerʱӰֽʲֵ
+	uint8_t* data = nullptr;
+	size_t capacity = 0; // 2
+	size_t mask = 0;
+	int bytesPerSec = 0;
+	PtsMarker markers[MARKER_COUNT];
+	char pad0[CACHELINE_SIZE];
+	std::atomic<size_t> head{ 0 }; // д
+	std::atomic<size_t> markerHead{ 0 };
+	PtsMarker curMarker; // marker
+	char pad1[CACHELINE_SIZE];
+	std::atomic<size_t> tail{ 0 }; // д
+	std::atomic<size_t> markerTail{ 0 };
+	std::atomic<size_t> wantFree{ 0 }; // ߵȴĿֽ
+	std::atomic<size_t> flushPos{ 0 }; // д߶ȡʱλ֮ǰ
+	char pad2[CACHELINE_SIZE];
+	std::atomic<bool> bAbort{ false };
+	std::atomic<bool> bInterrupt{ false }; // seekʱwaitWritable
+	WaitEvent notFull;
+
+	~AudioRingBuffer()
+	{
+		av_free(data);
+	}
+	void init(size_t minCapacity, int bytesPerSecond)
+	{
+		capacity = 1;
+		while (capacity < minCapacity)
+			capacity <<= 1;
+		mask = capacity - 1;
+		bytesPerSec = bytesPerSecond;
+		av_free(data);
+		data = (uint8_t*)av_mallocz(capacity);
+	}
+	size_t size()
+	{
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+	// ߣȴnֽڿУabortinterruptfalse
+	// ֵ1/4߲ÿλصȥ
+	bool waitWritable(size_t n)
+	{
+		n = FFMIN(n, capacity);
+		if (capacity - size() < n)
+		{
+			wantFree.store(FFMAX(n, capacity / 4));
+			notFull.wait([this, n] { return capacity - size() >= n || bAbort.load() || bInterrupt.load(); });
+		}
+		return !bInterrupt.exchange(false) && !bAbort.load();
+	}
+	// ߣȴǷnֽڿУûʱwaitWritableֵǼǣճnotFull֪ͨ
+	bool writable(size_t n)
+	{
+		n = FFMIN(n, capacity);
+		if (capacity - size() >= n)
+		{
+			return true;
+		}
+		wantFree.store(FFMAX(n, capacity / 4));
+		return capacity - size() >= n; // Ǽǰ߿Ѷ
+	}
+	// ߣֱдռ
+	uint8_t* writePtr(size_t* contiguous)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t freeBytes = capacity - (t - head.load(std::memory_order_acquire));
+		*contiguous = FFMIN(freeBytes, capacity - (t & mask));
+		return data + (t & mask);
+	}
+	// ߣдnֽڣptsΪʱ
+	void commit(size_t n, int64_t pts, float speed = 1.0f)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t mt = markerTail.load(std::memory_order_relaxed);
+		if (pts != AV_NOPTS_VALUE && mt - markerHead.load(std::memory_order_acquire) < MARKER_COUNT)
+		{
+			markers[mt & (MARKER_COUNT - 1)].offset = t;
+			markers[mt & (MARKER_COUNT - 1)].pts = pts;
+			markers[mt & (MARKER_COUNT - 1)].speed = speed;
+			markerTail.store(mt + 1, std::memory_order_release);
+		}
+		tail.store(t + n, std::memory_order_release);
+	}
+	// ߣmemcpyд벢ǰwaitWritable
+	void write(const uint8_t* src, size_t n, int64_t pts, float speed = 1.0f)
+	{
+		size_t off = tail.load(std::memory_order_relaxed) & mask;
+		size_t first = FFMIN(n, capacity - off);
+		memcpy(data + off, src, first);
+		memcpy(data, src + first, n - first);
+		commit(n, pts, speed);
+	}
+	// ߣmemcpyclockضʱ
+	// flushʱʹûҲǰheadߣflushһֱȴ
+	size_t read(uint8_t* dst, size_t n, int64_t* clock)
+	{
+		size_t start = head.load(std::memory_order_relaxed);
+		size_t h = start;
+		size_t f = flushPos.load(std::memory_order_acquire);
+		if ((ptrdiff_t)(f - h) > 0)
+		{
+			h = f; // seek֮ǰݣmarkerһ
+		}
+		n = FFMIN(n, tail.load(std::memory_order_acquire) - h);
+		if (n == 0 && h == start)
+		{
+			return 0;
+		}
+		if (n > 0)
+		{
+			size_t off = h & mask;
+			size_t first = FFMIN(n, capacity - off);
+			memcpy(dst, data + off, first);
+			memcpy(dst + first, data, n - first);
+		}
+
+		size_t mh = markerHead.load(std::memory_order_relaxed);
+		size_t mt = markerTail.load(std::memory_order_acquire);
+		while (mh != mt && markers[mh & (MARKER_COUNT - 1)].offset <= h)
+		{
+			curMarker = markers[mh & (MARKER_COUNT - 1)];
+			++mh;
+		}
+		markerHead.store(mh, std::memory_order_release);
+		if (n > 0 && clock && curMarker.pts != AV_NOPTS_VALUE)
+		{
+			*clock = curMarker.pts + (int64_t)((double)(h - curMarker.offset) * curMarker.speed * AV_TIME_BASE / bytesPerSec);
+		}
+
+		head.store(h + n, std::memory_order_release);
+		if (capacity - size() >= wantFree.load(std::memory_order_relaxed))
+		{
+			notFull.notify();
+		}
+		return n;
+	}
+	// ߣдδ
+	void flush()
+	{
+		flushPos.store(tail.load(std::memory_order_relaxed), std::memory_order_release);
+	}
+	// ̣߳еwaitWritableһ
+	void interrupt()
+	{
+		bInterrupt.store(true);
+		notFull.notify();
+	}
+	void abort()
+	{
+		bAbort.store(true);
+		notFull.notify();
+	}
+	// ˳ãݺmarkerbAbortinit֮֮ǰĶǾ
+	void reset()
+	{
+		head.store(0);
+		tail.store(0);
+		flushPos.store(0);
+		markerHead.store(0);
+		markerTail.store(0);
+		curMarker = PtsMarker();
+		wantFree.store(0);
+		bInterrupt.store(false);
+	}
+};
+
+struct PacketPool // AVPacketṹ帴óأֻ/رʱ͹黹
+{
+	std::vector<AVPacket*> freeList;
+	SDL_mutex* mutex = nullptr;
+	std::atomic<int64_t> allocCount{ 0 }; // av_packet_alloc
+	std::atomic<int64_t> reuseCount{ 0 };
+	PacketPool()
+	{
+		mutex = SDL_CreateMutex();
+	}
+	~PacketPool()
+	{
+		for (AVPacket* pkt : freeList)
+		{
+			av_packet_free(&pkt);
+		}
+		SDL_DestroyMutex(mutex);
+	}
+	AVPacket* acquire()
+	{
+		AVPacket* pkt = nullptr;
+		SDL_LockMutex(mutex);
+		if (!freeList.empty())
+		{
+			pkt = freeList.back();
+			freeList.pop_back();
+		}
+		SDL_UnlockMutex(mutex);
+		if (pkt)
+		{
+			reuseCount++;
+		}
+		else
+		{
+			pkt = av_packet_alloc();
+			allocCount++;
+		}
+		return pkt;
+	}
+	void release(AVPacket* pkt)
+	{
+		if (!pkt)
+		{
+			return;
+		}
+		av_packet_unref(pkt);
+		SDL_LockMutex(mutex);
+		freeList.push_back(pkt);
+		SDL_UnlockMutex(mutex);
+	}
+};
+
+struct PacketQueue // AVPacketУߵߵζ
+{
+	struct Slot
+	{
+		AVPacket* pkt = nullptr;
+		bool bLast = false; // 
+		int serial = 0; // дʱseek
+	};
+	Slot* ring = nullptr;
+	size_t capacity = 0; // 2
+	size_t mask = 0;
+	// head/tailֱռcache lineд߳α
+	char pad0[CACHELINE_SIZE];
+	std::atomic<size_t> head{ 0 }; // д
+	size_t cachedTail = 0; // ߻tail
+	char pad1[CACHELINE_SIZE];
+	std::atomic<size_t> tail{ 0 }; // д
+	size_t cachedHead = 0; // ߻head
+	char pad2[CACHELINE_SIZE];
+	std::atomic<bool> bAbort{ false };
+	WaitEvent notEmpty; // ߵȴ
+	WaitEvent notFull; // ߵȴ
+	PacketPool& pool;
+
+	PacketQueue(size_t maxCount, PacketPool& packetPool)
+		: pool(packetPool)
+	{
+		capacity = 1;
+		while (capacity < maxCount)
+			capacity <<= 1;
+		mask = capacity - 1;
+		ring = new Slot[capacity];
+		for (size_t i = 0; i < capacity; ++i)
+		{
+			ring[i].pkt = pool.acquire();
+		}
+	}
+	~PacketQueue()
+	{
+		for (size_t i = 0; i < capacity; ++i)
+		{
+			pool.release(ring[i].pkt);
+		}
+		delete[] ring;
+	}
+	// ߵãʱFULLҲȡinput
+	QueueState push(AVPacket* input, int serial = 0)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - cachedHead == capacity)
+		{
+			cachedHead = head.load(std::memory_order_acquire);
+			if (t - cachedHead == capacity)
+			{
+				return QueueState::FULL;
+			}
+		}
+		Slot& slot = ring[t & mask];
+		slot.bLast = !input;
+		slot.serial = serial;
+		if (input)
+		{
+			av_packet_move_ref(slot.pkt, input);
+		}
+		tail.store(t + 1, std::memory_order_release);
+		notEmpty.notify();
+		return QueueState::NORMAL;
+	}
+	// ߵãһԤȡmaxCountǻserial仯ֹͣ
+	// LASTʾѽǣ*countΪȡİ*serialΪseek
+	QueueState popBatch(AVPacket** outputs, size_t maxCount, size_t* count, int* serial = nullptr)
+	{
+		*count = 0;
+		size_t h = head.load(std::memory_order_relaxed);
+		if (cachedTail - h < maxCount)
+		{
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (h == cachedTail)
+			{
+				return QueueState::EMPTY;
+			}
+		}
+		QueueState state = QueueState::NORMAL;
+		size_t end = h + std::min(maxCount, cachedTail - h);
+		size_t cur = h;
+		int batchSerial = ring[h & mask].serial;
+		while (cur != end && ring[cur & mask].serial == batchSerial)
+		{
+			Slot& slot = ring[cur++ & mask];
+			if (slot.bLast)
+			{
+				state = QueueState::LAST;
+				break;
+			}
+			AVPacket* output = outputs[(*count)++];
+			av_packet_unref(output);
+			av_packet_move_ref(output, slot.pkt);
+		}
+		head.store(cur, std::memory_order_release);
+		notFull.notify();
+		if (serial)
+		{
+			*serial = batchSerial;
+		}
+		return state;
+	}
+	QueueState pop(AVPacket* output)
+	{
+		size_t count;
+		return popBatch(&output, 1, &count);
+	}
+	// 汾abort󷵻FULL
+	QueueState waitPush(AVPacket* input, int serial = 0)
+	{
+		QueueState state = push(input, serial);
+		while (state == QueueState::FULL && !bAbort.load(std::memory_order_relaxed))
+		{
+			notFull.wait([this] { return size() < capacity || bAbort.load(); });
+			state = push(input, serial);
+		}
+		return state;
+	}
+	// bBlockΪfalseʱfalseaborttrue
+	bool offer(AVPacket* input, bool bBlock, int serial = 0)
+	{
+		QueueState state = bBlock ? waitPush(input, serial) : push(input, serial);
+		return state != QueueState::FULL || bAbort.load(std::memory_order_relaxed);
+	}
+	// 汾abort󷵻EMPTY
+	QueueState waitPopBatch(AVPacket** outputs, size_t maxCount, size_t* count, int* serial = nullptr)
+	{
+		QueueState state = popBatch(outputs, maxCount, count, serial);
+		while (state == QueueState::EMPTY && !bAbort.load(std::memory_order_relaxed))
+		{
+			notEmpty.wait([this] { return size() > 0 || bAbort.load(); });
+			state = popBatch(outputs, maxCount, count, serial);
+		}
+		return state;
+	}
+	QueueState waitPop(AVPacket* output)
+	{
+		size_t count;
+		return waitPopBatch(&output, 1, &count);
+	}
+	size_t size()
+	{
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+	void abort() // еpush/pop
+	{
+		bAbort.store(true, std::memory_order_relaxed);
+		notEmpty.notify();
+		notFull.notify();
+	}
+	// ߺ߶˳ãʣİabort
+	void reset()
+	{
+		size_t t = tail.load();
+		for (size_t h = head.load(); h != t; ++h)
+		{
+			av_packet_unref(ring[h & mask].pkt);
+		}
+		head.store(t);
+		cachedHead = t;
+		cachedTail = t;
+		bAbort.store(false);
+	}
+};
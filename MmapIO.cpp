@@ -0,0 +1,208 @@
+#include "MmapIO.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MmapIO::~MmapIO()
+{
+	close();
+}
+
+bool MmapIO::isLocalPath(const std::string& filePath)
+{
+	// Эurl(file:)ffmpeg
+	return !filePath.empty() && filePath.find("://") == std::string::npos && filePath.compare(0, 5, "file:") != 0;
+}
+
+bool MmapIO::open(const std::string& filePath)
+{
+	close();
+#ifdef _WIN32
+	// ·utf-8
+	int len = MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, nullptr, 0);
+	std::wstring widePath(len, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, &widePath[0], len);
+	HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	// 32λӳ䲻˴ļfalse˻fileЭ
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!data)
+	{
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+	m_file = file;
+	m_mapping = mapping;
+	m_size = size.QuadPart;
+#else
+	int fd = ::open(filePath.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat st;
+	void* data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	if (data == MAP_FAILED)
+	{
+		::close(fd);
+		return false;
+	}
+	madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+	m_fd = fd;
+	m_size = st.st_size;
+#endif
+	m_data = (const uint8_t*)data;
+	m_pos = 0;
+	m_adviseEnd = 0;
+	adviseWindow();
+
+	uint8_t* buffer = (uint8_t*)av_malloc(IO_BUFFER_SIZE);
+	m_avioCtx = avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this, readPacket, nullptr, seek);
+	std::cout << "[mmap io]: " << m_size << " bytes mapped" << std::endl;
+	return true;
+}
+
+void MmapIO::close()
+{
+	if (m_avioCtx)
+	{
+		av_freep(&m_avioCtx->buffer);
+		avio_context_free(&m_avioCtx);
+	}
+#ifdef _WIN32
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+	if (m_file)
+	{
+		CloseHandle(m_file);
+		m_file = nullptr;
+	}
+#else
+	if (m_data)
+	{
+		munmap((void*)m_data, (size_t)m_size);
+	}
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_pos = 0;
+}
+
+int MmapIO::readPacket(void* opaque, uint8_t* buf, int bufSize)
+{
+	MmapIO* obj = static_cast<MmapIO*>(opaque);
+	int64_t len = FFMIN((int64_t)bufSize, obj->m_size - obj->m_pos);
+	if (len <= 0)
+	{
+		return AVERROR_EOF;
+	}
+	memcpy(buf, obj->m_data + obj->m_pos, (size_t)len);
+	obj->m_pos += len;
+	obj->adviseWindow();
+	return (int)len;
+}
+
+int64_t MmapIO::seek(void* opaque, int64_t offset, int whence)
+{
+	MmapIO* obj = static_cast<MmapIO*>(opaque);
+	int64_t pos = 0;
+	switch (whence & ~AVSEEK_FORCE)
+	{
+	case AVSEEK_SIZE:
+		return obj->m_size;
+	case SEEK_SET:
+		pos = offset;
+		break;
+	case SEEK_CUR:
+		pos = obj->m_pos + offset;
+		break;
+	case SEEK_END:
+		pos = obj->m_size + offset;
+		break;
+	default:
+		return AVERROR(EINVAL);
+	}
+	if (pos < 0 || pos > obj->m_size)
+	{
+		return AVERROR(EINVAL);
+	}
+	// Ԥ֮ʱλʾ
+	if (pos < obj->m_pos || pos >= obj->m_adviseEnd)
+	{
+		obj->m_adviseEnd = pos;
+	}
+	obj->m_pos = pos;
+	obj->adviseWindow();
+	return pos;
+}
+
+void MmapIO::adviseWindow()
+{
+	if (m_adviseEnd - m_pos > ADVISE_WINDOW / 2 || m_adviseEnd >= m_size)
+	{
+		return;
+	}
+	int64_t start = FFMAX(m_adviseEnd, m_pos);
+	int64_t end = FFMIN(m_pos + ADVISE_WINDOW, m_size);
+#ifdef _WIN32
+	// PrefetchVirtualMemoryҪWin8ϵͳϿFILE_FLAG_SEQUENTIAL_SCAN
+	struct MemoryRange // WIN32_MEMORY_RANGE_ENTRY
+	{
+		PVOID address;
+		SIZE_T size;
+	};
+	typedef BOOL(WINAPI* PrefetchFunc)(HANDLE, ULONG_PTR, MemoryRange*, ULONG);
+	static PrefetchFunc prefetch = (PrefetchFunc)GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory");
+	if (prefetch)
+	{
+		MemoryRange range = { (PVOID)(m_data + start), (SIZE_T)(end - start) };
+		prefetch(GetCurrentProcess(), 1, &range, 0);
+	}
+#else
+	// madviseҪҳ
+	static const int64_t pageSize = sysconf(_SC_PAGESIZE);
+	int64_t alignedStart = start / pageSize * pageSize;
+	madvise((void*)(m_data + alignedStart), (size_t)(end - alignedStart), MADV_WILLNEED);
+#endif
+	m_adviseEnd = end;
+}
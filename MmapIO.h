@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+#include "libavformat/avio.h"
+#include "libavutil/avutil.h"
+}
+
+// ڴӳıļAVIOContextȡֻmemcpyÿ32KBһreadϵͳ
+// ȡλǰһΰʾϵͳԤseek󴰿ڸƶ
+class MmapIO
+{
+public:
+	MmapIO() = default;
+	~MmapIO();
+
+	static bool isLocalPath(const std::string& filePath);
+
+	bool open(const std::string& filePath); // ɹavioContext()ɽAVFormatContext::pb
+	void close();
+	AVIOContext* avioContext()
+	{
+		return m_avioCtx;
+	}
+
+private:
+	static int readPacket(void* opaque, uint8_t* buf, int bufSize);
+	static int64_t seek(void* opaque, int64_t offset, int whence);
+	void adviseWindow(); // ȡλóϴԤڵһʱʾһ
+
+	const uint8_t* m_data = nullptr;
+	int64_t m_size = 0;
+	int64_t m_pos = 0;
+	int64_t m_adviseEnd = 0; // ʾԤλ
+	AVIOContext* m_avioCtx = nullptr;
+#ifdef _WIN32
+	void* m_file = nullptr; // HANDLE
+	void* m_mapping = nullptr;
+#else
+	int m_fd = -1;
+#endif
+
+	const int IO_BUFFER_SIZE = 256 * 1024; // AVIOContextĻ壬ԽصԽ
+	const int64_t ADVISE_WINDOW = 8 * 1024 * 1024;
+};
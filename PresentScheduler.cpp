@@ -0,0 +1,89 @@
+#include "PresentScheduler.h"
+
+#include <thread>
+
+const int64_t PresentScheduler::BUCKET_LIMITS[HISTOGRAM_BUCKETS] = {
+	250, 500, 1000, 2000, 4000, 8000, 16000, INT64_MAX,
+};
+
+PresentScheduler::PresentScheduler()
+{
+	for (auto& count : m_histogram)
+	{
+		count = 0;
+	}
+}
+
+void PresentScheduler::reset()
+{
+	m_lastTarget = AV_NOPTS_VALUE;
+}
+
+void PresentScheduler::abort()
+{
+	m_bAbort = true;
+}
+
+void PresentScheduler::resume()
+{
+	m_bAbort = false;
+	m_lastTarget = AV_NOPTS_VALUE;
+}
+
+int64_t PresentScheduler::nextTarget(int64_t interval, int64_t maxLag)
+{
+	int64_t now = av_gettime_relative();
+	if (m_lastTarget == AV_NOPTS_VALUE || m_lastTarget + interval < now - maxLag)
+	{
+		m_lastTarget = now;
+	}
+	else
+	{
+		m_lastTarget += interval;
+	}
+	return m_lastTarget;
+}
+
+int64_t PresentScheduler::waitUntil(int64_t target)
+{
+	int64_t now = av_gettime_relative();
+	// ˯ߵtarget֮ǰSPIN_US+ӳ
+	while (!m_bAbort && target - now > SPIN_US + m_wakeupSlack)
+	{
+		int64_t sleepUs = FFMIN(target - now - SPIN_US - m_wakeupSlack, MAX_SLEEP_US);
+		av_usleep((unsigned)sleepUs);
+		int64_t woke = av_gettime_relative();
+		// ʱƽֵ1/8Ȩ
+		int64_t overshoot = FFMAX(woke - now - sleepUs, 0);
+		m_wakeupSlack = FFMIN(m_wakeupSlack + (overshoot - m_wakeupSlack) / 8, MAX_SLACK_US);
+		now = woke;
+	}
+	// ʣಿ
+	while (!m_bAbort && now < target)
+	{
+		std::this_thread::yield();
+		now = av_gettime_relative();
+	}
+
+	int64_t lateness = FFMAX(now - target, 0);
+	int bucket = 0;
+	while (lateness >= BUCKET_LIMITS[bucket])
+	{
+		++bucket;
+	}
+	m_histogram[bucket]++;
+	return lateness;
+}
+
+std::string PresentScheduler::summary() const
+{
+	std::string text;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; ++i)
+	{
+		text += i + 1 < HISTOGRAM_BUCKETS ? "<" + std::to_string(BUCKET_LIMITS[i]) + "us:" :
+			">=" + std::to_string(BUCKET_LIMITS[i - 1]) + "us:";
+		text += std::to_string(m_histogram[i].load());
+		text += i + 1 < HISTOGRAM_BUCKETS ? " " : "";
+	}
+	return text;
+}
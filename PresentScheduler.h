@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+extern "C"
+{
+#include "libavutil/avutil.h"
+#include "libavutil/time.h"
+}
+
+// Ƶ֡ʾȣĿʱǵʱϵľʱ䣨΢룩
+// ȴ˯ߣһС˯߶Ļӳټ´εǰ
+class PresentScheduler
+{
+public:
+	static const int HISTOGRAM_BUCKETS = 8;
+
+	PresentScheduler();
+
+	void reset(); // һ֡ԵǰʱΪ׼
+	void abort(); // ѵȴеwaitUntil
+	void resume(); // abort´ʱ
+
+	// һ֡Ŀintervalõ֡Ŀ꣬󳬹maxLagʱԵǰʱΪ׼׷
+	int64_t nextTarget(int64_t interval, int64_t maxLag);
+	// ȵtargetlatenessʵʾʱ-targetֱͼ
+	int64_t waitUntil(int64_t target);
+
+	unsigned long long histogram(int bucket) const
+	{
+		return m_histogram[bucket].load();
+	}
+	static int64_t bucketLimit(int bucket) // ÷ּlatenessޣһ
+	{
+		return BUCKET_LIMITS[bucket];
+	}
+	std::string summary() const; // "<250us:10 <500us:2 ..."
+	int64_t wakeupSlack() const
+	{
+		return m_wakeupSlack;
+	}
+
+private:
+	static const int64_t BUCKET_LIMITS[HISTOGRAM_BUCKETS];
+
+	int64_t m_lastTarget = AV_NOPTS_VALUE;
+	int64_t m_wakeupSlack = 0; // ˯ߵƽʱǰô
+	std::atomic<bool> m_bAbort{ false };
+	std::atomic<unsigned long long> m_histogram[HISTOGRAM_BUCKETS];
+
+	const int64_t SPIN_US = 1000; // ʱ
+	const int64_t MAX_SLEEP_US = 20000; // ֶ˯ߣʱӦabort
+	const int64_t MAX_SLACK_US = 4000;
+};
@@ -0,0 +1,212 @@
+#include "ProbeCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <iostream>
+#include <functional>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+
+bool ProbeCache::open(const std::string& filePath, const std::string& cacheDir)
+{
+	m_entryPath.clear();
+	QFileInfo info(QString::fromStdString(filePath));
+	if (!info.isFile() || !QDir().mkpath(QString::fromStdString(cacheDir)))
+	{
+		return false;
+	}
+	m_filePath = filePath;
+	m_size = info.size();
+	m_mtime = info.lastModified().toMSecsSinceEpoch();
+	// ·hashͻʱĿб·һ£δд
+	char key[32];
+	snprintf(key, sizeof(key), "%016llx.probe", (unsigned long long)std::hash<std::string>()(filePath));
+	m_entryPath = cacheDir + "/" + key;
+	return true;
+}
+
+bool ProbeCache::load(AVFormatContext* fmtCtx)
+{
+	if (m_entryPath.empty())
+	{
+		return false;
+	}
+	FILE* fp = fopen(m_entryPath.c_str(), "rb");
+	if (!fp)
+	{
+		return false;
+	}
+	Header header;
+	bool bOk = fread(&header, sizeof(header), 1, fp) == 1 && header.magic == ENTRY_MAGIC && header.version == ENTRY_VERSION &&
+		header.size == m_size && header.mtime == m_mtime && header.pathLength == (int32_t)m_filePath.size() &&
+		header.streamCount == (int32_t)fmtCtx->nb_streams;
+	if (bOk)
+	{
+		std::string path(header.pathLength, '\0');
+		bOk = fread(&path[0], 1, path.size(), fp) == path.size() && path == m_filePath;
+	}
+	// ȫ˶ԺдfmtCtx;һʱ¸һĲ
+	std::vector<StreamEntry> entries(bOk ? header.streamCount : 0);
+	std::vector<std::vector<uint8_t>> extradata(entries.size());
+	for (size_t i = 0; bOk && i < entries.size(); ++i)
+	{
+		StreamEntry& entry = entries[i];
+		AVStream* st = fmtCtx->streams[i];
+		bOk = fread(&entry, sizeof(entry), 1, fp) == 1 && entry.codecType == st->codecpar->codec_type &&
+			entry.codecId == st->codecpar->codec_id && av_cmp_q(entry.timeBase, st->time_base) == 0 &&
+			entry.extradataSize >= 0 && entry.extradataSize <= MAX_EXTRADATA_SIZE;
+		if (bOk)
+		{
+			extradata[i].resize(entry.extradataSize);
+			bOk = fread(extradata[i].data(), 1, extradata[i].size(), fp) == extradata[i].size();
+		}
+		// demuxerѶextradataʱͬͬ˵ļݱ
+		if (bOk && st->codecpar->extradata_size > 0)
+		{
+			bOk = st->codecpar->extradata_size == entry.extradataSize &&
+				memcmp(st->codecpar->extradata, extradata[i].data(), entry.extradataSize) == 0;
+		}
+	}
+	fclose(fp);
+	if (!bOk)
+	{
+		std::cout << "[probe cache]: mismatch, probing " << m_filePath << std::endl;
+		return false;
+	}
+
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const StreamEntry& entry = entries[i];
+		AVStream* st = fmtCtx->streams[i];
+		AVCodecParameters* par = st->codecpar;
+		par->codec_tag = entry.codecTag;
+		par->format = entry.format;
+		par->bit_rate = entry.bitRate;
+		par->bits_per_coded_sample = entry.bitsPerCodedSample;
+		par->bits_per_raw_sample = entry.bitsPerRawSample;
+		par->profile = entry.profile;
+		par->level = entry.level;
+		par->width = entry.width;
+		par->height = entry.height;
+		par->sample_aspect_ratio = entry.sampleAspectRatio;
+		par->field_order = (AVFieldOrder)entry.fieldOrder;
+		par->color_range = (AVColorRange)entry.colorRange;
+		par->color_primaries = (AVColorPrimaries)entry.colorPrimaries;
+		par->color_trc = (AVColorTransferCharacteristic)entry.colorTrc;
+		par->color_space = (AVColorSpace)entry.colorSpace;
+		par->chroma_location = (AVChromaLocation)entry.chromaLocation;
+		par->video_delay = entry.videoDelay;
+		par->channel_layout = entry.channelLayout;
+		par->channels = entry.channels;
+		par->sample_rate = entry.sampleRate;
+		par->block_align = entry.blockAlign;
+		par->frame_size = entry.frameSize;
+		par->initial_padding = entry.initialPadding;
+		par->trailing_padding = entry.trailingPadding;
+		par->seek_preroll = entry.seekPreroll;
+		if (par->extradata_size == 0 && entry.extradataSize > 0)
+		{
+			par->extradata = (uint8_t*)av_mallocz(entry.extradataSize + AV_INPUT_BUFFER_PADDING_SIZE);
+			memcpy(par->extradata, extradata[i].data(), entry.extradataSize);
+			par->extradata_size = entry.extradataSize;
+		}
+		st->avg_frame_rate = entry.avgFrameRate;
+		st->r_frame_rate = entry.rFrameRate;
+		if (st->start_time == AV_NOPTS_VALUE)
+		{
+			st->start_time = entry.startTime;
+		}
+		if (st->duration == AV_NOPTS_VALUE)
+		{
+			st->duration = entry.duration;
+		}
+	}
+	// ⼸ԭavformat_find_stream_info
+	if (fmtCtx->start_time == AV_NOPTS_VALUE)
+	{
+		fmtCtx->start_time = header.startTime;
+	}
+	if (fmtCtx->duration == AV_NOPTS_VALUE)
+	{
+		fmtCtx->duration = header.duration;
+	}
+	if (fmtCtx->bit_rate <= 0)
+	{
+		fmtCtx->bit_rate = header.bitRate;
+	}
+	return true;
+}
+
+void ProbeCache::store(AVFormatContext* fmtCtx)
+{
+	if (m_entryPath.empty())
+	{
+		return;
+	}
+	FILE* fp = fopen(m_entryPath.c_str(), "wb");
+	if (!fp)
+	{
+		return;
+	}
+	Header header = {};
+	header.magic = ENTRY_MAGIC;
+	header.version = ENTRY_VERSION;
+	header.size = m_size;
+	header.mtime = m_mtime;
+	header.pathLength = (int32_t)m_filePath.size();
+	header.streamCount = (int32_t)fmtCtx->nb_streams;
+	header.startTime = fmtCtx->start_time;
+	header.duration = fmtCtx->duration;
+	header.bitRate = fmtCtx->bit_rate;
+	bool bOk = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		fwrite(m_filePath.data(), 1, m_filePath.size(), fp) == m_filePath.size();
+	for (unsigned int i = 0; bOk && i < fmtCtx->nb_streams; ++i)
+	{
+		AVStream* st = fmtCtx->streams[i];
+		AVCodecParameters* par = st->codecpar;
+		StreamEntry entry = {};
+		entry.codecType = par->codec_type;
+		entry.codecId = par->codec_id;
+		entry.codecTag = par->codec_tag;
+		entry.format = par->format;
+		entry.bitRate = par->bit_rate;
+		entry.bitsPerCodedSample = par->bits_per_coded_sample;
+		entry.bitsPerRawSample = par->bits_per_raw_sample;
+		entry.profile = par->profile;
+		entry.level = par->level;
+		entry.width = par->width;
+		entry.height = par->height;
+		entry.sampleAspectRatio = par->sample_aspect_ratio;
+		entry.fieldOrder = par->field_order;
+		entry.colorRange = par->color_range;
+		entry.colorPrimaries = par->color_primaries;
+		entry.colorTrc = par->color_trc;
+		entry.colorSpace = par->color_space;
+		entry.chromaLocation = par->chroma_location;
+		entry.videoDelay = par->video_delay;
+		entry.channelLayout = par->channel_layout;
+		entry.channels = par->channels;
+		entry.sampleRate = par->sample_rate;
+		entry.blockAlign = par->block_align;
+		entry.frameSize = par->frame_size;
+		entry.initialPadding = par->initial_padding;
+		entry.trailingPadding = par->trailing_padding;
+		entry.seekPreroll = par->seek_preroll;
+		entry.timeBase = st->time_base;
+		entry.avgFrameRate = st->avg_frame_rate;
+		entry.rFrameRate = st->r_frame_rate;
+		entry.startTime = st->start_time;
+		entry.duration = st->duration;
+		entry.extradataSize = par->extradata_size;
+		bOk = fwrite(&entry, sizeof(entry), 1, fp) == 1 &&
+			fwrite(par->extradata, 1, par->extradata_size, fp) == (size_t)par->extradata_size;
+	}
+	fclose(fp);
+	if (!bOk)
+	{
+		// дһĿȡʱȲҲᰴδдֱɾ
+		remove(m_entryPath.c_str());
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+#include "libavutil/avutil.h"
+}
+
+// ļavformat_find_stream_infoĴ̻棬·+С+޸ʱ
+// ÿļһĿcodecparextradataʱ֡ʣʱ̽
+class ProbeCache
+{
+public:
+	// ȡļС޸ʱ䣬ʧ(Ǳļ)ʱfalse֮load/store
+	bool open(const std::string& filePath, const std::string& cacheDir);
+	// avformat_open_input֮ãĿĲdemuxerһʱtrue
+	bool load(AVFormatContext* fmtCtx);
+	void store(AVFormatContext* fmtCtx); // ̽ɺãǾĿ
+
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		int64_t size; // ԴļС
+		int64_t mtime; // Դļ޸ʱ䣬
+		int32_t pathLength; // ·ٽӸStreamEntryextradata
+		int32_t streamCount;
+		int64_t startTime;
+		int64_t duration;
+		int64_t bitRate;
+	};
+	struct StreamEntry
+	{
+		int32_t codecType;
+		int32_t codecId;
+		uint32_t codecTag;
+		int32_t format;
+		int64_t bitRate;
+		int32_t bitsPerCodedSample;
+		int32_t bitsPerRawSample;
+		int32_t profile;
+		int32_t level;
+		int32_t width;
+		int32_t height;
+		AVRational sampleAspectRatio;
+		int32_t fieldOrder;
+		int32_t colorRange;
+		int32_t colorPrimaries;
+		int32_t colorTrc;
+		int32_t colorSpace;
+		int32_t chromaLocation;
+		int32_t videoDelay;
+		uint64_t channelLayout;
+		int32_t channels;
+		int32_t sampleRate;
+		int32_t blockAlign;
+		int32_t frameSize;
+		int32_t initialPadding;
+		int32_t trailingPadding;
+		int32_t seekPreroll;
+		AVRational timeBase;
+		AVRational avgFrameRate;
+		AVRational rFrameRate;
+		int64_t startTime;
+		int64_t duration;
+		int32_t extradataSize;
+	};
+
+	std::string m_filePath;
+	std::string m_entryPath; // ձʾopenʧ
+	int64_t m_size = 0;
+	int64_t m_mtime = 0;
+
+	const uint32_t ENTRY_MAGIC = 0x48435050; // "PPCH"
+	const uint32_t ENTRY_VERSION = 1;
+	const int32_t MAX_EXTRADATA_SIZE = 16 * 1024 * 1024; // Ŀʱĳȷ
+};
@@ -0,0 +1,298 @@
+#include "ReadAheadIO.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+extern "C"
+{
+#include "libavutil/time.h"
+}
+
+ReadAheadIO::ReadAheadIO()
+{
+	m_mutex = SDL_CreateMutex();
+	m_cond = SDL_CreateCond();
+}
+
+ReadAheadIO::~ReadAheadIO()
+{
+	close();
+	SDL_DestroyCond(m_cond);
+	SDL_DestroyMutex(m_mutex);
+}
+
+bool ReadAheadIO::open(const std::string& filePath, int chunkCount, int throttleKBps)
+{
+	close();
+#ifdef _WIN32
+	int len = MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, nullptr, 0);
+	std::wstring widePath(len, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, filePath.c_str(), -1, &widePath[0], len);
+	HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size;
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	m_file = file;
+	m_size = size.QuadPart;
+#else
+	int fd = ::open(filePath.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0)
+	{
+		return false;
+	}
+	if (fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	m_fd = fd;
+	m_size = st.st_size;
+#endif
+	m_chunkCount = FFMAX(chunkCount, 1);
+	m_chunks = new Chunk[m_chunkCount];
+	for (int i = 0; i < m_chunkCount; ++i)
+	{
+		m_chunks[i].data = (uint8_t*)av_malloc(CHUNK_SIZE);
+	}
+	m_throttleKBps = throttleKBps;
+	m_pos = 0;
+	m_windowStart = 0;
+	m_bAbort = false;
+	m_thread = SDL_CreateThread(ioThread, "readAhead", this);
+
+	uint8_t* buffer = (uint8_t*)av_malloc(IO_BUFFER_SIZE);
+	m_avioCtx = avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this, readPacket, nullptr, seek);
+	return true;
+}
+
+void ReadAheadIO::close()
+{
+	SDL_LockMutex(m_mutex);
+	m_bAbort = true;
+	SDL_CondBroadcast(m_cond);
+	SDL_UnlockMutex(m_mutex);
+	SDL_WaitThread(m_thread, NULL);
+	m_thread = nullptr;
+
+	if (m_avioCtx)
+	{
+		av_freep(&m_avioCtx->buffer);
+		avio_context_free(&m_avioCtx);
+		std::cout << "[read ahead]: hit " << m_hits << " stall " << m_stalls << " stall time "
+			<< m_stallTime / 1000 << " ms" << std::endl;
+	}
+	if (m_chunks)
+	{
+		for (int i = 0; i < m_chunkCount; ++i)
+		{
+			av_freep(&m_chunks[i].data);
+		}
+		delete[] m_chunks;
+		m_chunks = nullptr;
+	}
+#ifdef _WIN32
+	if (m_file)
+	{
+		CloseHandle(m_file);
+		m_file = nullptr;
+	}
+#else
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+	m_hits = 0;
+	m_stalls = 0;
+	m_stallTime = 0;
+}
+
+bool ReadAheadIO::readAt(int64_t offset, uint8_t* buf, int size, int* readSize)
+{
+	*readSize = 0;
+	while (*readSize < size)
+	{
+#ifdef _WIN32
+		// ͬϴOVERLAPPEDƫƵReadFile൱pread
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)(offset & 0xffffffff);
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		DWORD got = 0;
+		if (!ReadFile(m_file, buf + *readSize, size - *readSize, &got, &overlapped) && GetLastError() != ERROR_HANDLE_EOF)
+		{
+			return false;
+		}
+#else
+		ssize_t got = pread(m_fd, buf + *readSize, size - *readSize, offset);
+		if (got < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return false;
+		}
+#endif
+		if (got == 0)
+		{
+			break;
+		}
+		*readSize += (int)got;
+		offset += got;
+	}
+	return true;
+}
+
+int ReadAheadIO::ioThread(void* data)
+{
+	ReadAheadIO* obj = static_cast<ReadAheadIO*>(data);
+	SDL_LockMutex(obj->m_mutex);
+	while (!obj->m_bAbort)
+	{
+		// ȡλδ
+		Chunk* chunk = nullptr;
+		int64_t index = obj->m_windowStart;
+		for (; index < obj->m_windowStart + obj->m_chunkCount && index * CHUNK_SIZE < obj->m_size; ++index)
+		{
+			Chunk& c = obj->m_chunks[index % obj->m_chunkCount];
+			if (c.index != index || !c.bReady)
+			{
+				chunk = &c;
+				break;
+			}
+		}
+		if (!chunk)
+		{
+			SDL_CondWait(obj->m_cond, obj->m_mutex);
+			continue;
+		}
+		chunk->index = index;
+		chunk->bReady = false;
+		SDL_UnlockMutex(obj->m_mutex);
+
+		// λֻб̸߳дȡڼ䲻bReadyΪfalseʱdemuxλ
+		int64_t start = av_gettime_relative();
+		int want = (int)FFMIN((int64_t)CHUNK_SIZE, obj->m_size - index * CHUNK_SIZE);
+		int size = 0;
+		if (!obj->readAt(index * CHUNK_SIZE, chunk->data, want, &size))
+		{
+			size = 0; // demuxʱش
+		}
+		if (obj->m_throttleKBps > 0)
+		{
+			int64_t spend = (int64_t)size * 1000 / obj->m_throttleKBps * AV_TIME_BASE / (1024 * 1000);
+			int64_t elapsed = av_gettime_relative() - start;
+			if (spend > elapsed)
+			{
+				av_usleep((unsigned)(spend - elapsed));
+			}
+		}
+
+		SDL_LockMutex(obj->m_mutex);
+		chunk->size = size;
+		chunk->bReady = true;
+		SDL_CondBroadcast(obj->m_cond);
+	}
+	SDL_UnlockMutex(obj->m_mutex);
+	return 0;
+}
+
+int ReadAheadIO::readPacket(void* opaque, uint8_t* buf, int bufSize)
+{
+	ReadAheadIO* obj = static_cast<ReadAheadIO*>(opaque);
+	SDL_LockMutex(obj->m_mutex);
+	if (obj->m_pos >= obj->m_size)
+	{
+		SDL_UnlockMutex(obj->m_mutex);
+		return AVERROR_EOF;
+	}
+	int64_t index = obj->m_pos / CHUNK_SIZE;
+	// ڸȡλãI/O̴߳￪ʼ
+	if (index != obj->m_windowStart)
+	{
+		obj->m_windowStart = index;
+		SDL_CondBroadcast(obj->m_cond);
+	}
+	Chunk& chunk = obj->m_chunks[index % obj->m_chunkCount];
+	if (chunk.index == index && chunk.bReady)
+	{
+		obj->m_hits++;
+	}
+	else
+	{
+		obj->m_stalls++;
+		int64_t start = av_gettime_relative();
+		while (!(chunk.index == index && chunk.bReady) && !obj->m_bAbort)
+		{
+			SDL_CondWait(obj->m_cond, obj->m_mutex);
+		}
+		obj->m_stallTime += av_gettime_relative() - start;
+	}
+	int len = AVERROR_EXIT;
+	if (!obj->m_bAbort)
+	{
+		int offset = (int)(obj->m_pos - index * CHUNK_SIZE);
+		len = FFMIN(bufSize, chunk.size - offset);
+		if (len > 0)
+		{
+			memcpy(buf, chunk.data + offset, len);
+			obj->m_pos += len;
+		}
+		else
+		{
+			len = AVERROR(EIO); // ȡʧܻļ
+		}
+	}
+	SDL_UnlockMutex(obj->m_mutex);
+	return len;
+}
+
+int64_t ReadAheadIO::seek(void* opaque, int64_t offset, int whence)
+{
+	ReadAheadIO* obj = static_cast<ReadAheadIO*>(opaque);
+	int64_t pos = 0;
+	switch (whence & ~AVSEEK_FORCE)
+	{
+	case AVSEEK_SIZE:
+		return obj->m_size;
+	case SEEK_SET:
+		pos = offset;
+		break;
+	case SEEK_CUR:
+		pos = obj->m_pos + offset;
+		break;
+	case SEEK_END:
+		pos = obj->m_size + offset;
+		break;
+	default:
+		return AVERROR(EINVAL);
+	}
+	if (pos < 0 || pos > obj->m_size)
+	{
+		return AVERROR(EINVAL);
+	}
+	// ֻƶȡλã´ζȡʱڸȥ´ѾĿ鲻ض
+	SDL_LockMutex(obj->m_mutex);
+	obj->m_pos = pos;
+	SDL_UnlockMutex(obj->m_mutex);
+	return pos;
+}
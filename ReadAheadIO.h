@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+#include "libavformat/avio.h"
+#include "libavutil/avutil.h"
+#include "SDL2/SDL.h"
+#include <SDL2/SDL_thread.h>
+}
+
+// ļԤAVIOContextI/O̰߳(pread)ȡλ֮Ĵ
+// 鰴ֱӳ䵽λڵλһһӦseek´ڵĿЧ
+class ReadAheadIO
+{
+public:
+	ReadAheadIO();
+	~ReadAheadIO();
+
+	// chunkCountCHUNK_SIZEĿ飬throttleKBps>0ʱI/O̰߳˴٣ģٴ洢
+	bool open(const std::string& filePath, int chunkCount, int throttleKBps);
+	void close();
+	AVIOContext* avioContext()
+	{
+		return m_avioCtx;
+	}
+
+	int64_t hits() const // ҪȴĶȡ
+	{
+		return m_hits;
+	}
+	int64_t stalls() const // δȴI/O̵߳Ĵ
+	{
+		return m_stalls;
+	}
+	int64_t stallTime() const // ΢
+	{
+		return m_stallTime;
+	}
+
+	static const int CHUNK_SIZE = 1024 * 1024;
+
+private:
+	struct Chunk
+	{
+		int64_t index = -1; // ļеĿ
+		int size = 0;
+		bool bReady = false;
+		uint8_t* data = nullptr;
+	};
+
+	static int readPacket(void* opaque, uint8_t* buf, int bufSize);
+	static int64_t seek(void* opaque, int64_t offset, int whence);
+	static int ioThread(void* data);
+	bool readAt(int64_t offset, uint8_t* buf, int size, int* readSize); // λöıļָ
+
+	Chunk* m_chunks = nullptr;
+	int m_chunkCount = 0;
+	int m_throttleKBps = 0;
+	int64_t m_size = 0;
+	int64_t m_pos = 0; // demuxȡλ
+	int64_t m_windowStart = 0; // ڵһ
+
+	SDL_Thread* m_thread = nullptr;
+	SDL_mutex* m_mutex = nullptr; // ״̬ʹ
+	SDL_cond* m_cond = nullptr; // ƶʱ㲥
+	bool m_bAbort = false;
+	AVIOContext* m_avioCtx = nullptr;
+#ifdef _WIN32
+	void* m_file = nullptr; // HANDLE
+#else
+	int m_fd = -1;
+#endif
+
+	std::atomic<int64_t> m_hits{ 0 };
+	std::atomic<int64_t> m_stalls{ 0 };
+	std::atomic<int64_t> m_stallTime{ 0 };
+
+	const int IO_BUFFER_SIZE = 256 * 1024;
+};
@@ -0,0 +1,270 @@
+#include "ThumbnailProvider.h"
+
+#include <QUrl>
+#include <iostream>
+
+static qint64 imageBytes(const QImage& image)
+{
+	return (qint64)image.bytesPerLine() * image.height();
+}
+
+ThumbnailProvider::ThumbnailProvider()
+	: QQuickImageProvider(QQuickImageProvider::Image, QQmlImageProviderBase::ForceAsynchronousImageLoading)
+{
+	m_mutex = SDL_CreateMutex();
+}
+
+ThumbnailProvider::~ThumbnailProvider()
+{
+	if (m_decodedCount > 0)
+	{
+		std::cout << "[thumbnail]: " << m_decodedCount << " decoded, " << thumbnailsPerSecond() << "/s" << std::endl;
+	}
+	closeSource();
+	SDL_DestroyMutex(m_mutex);
+}
+
+QImage ThumbnailProvider::requestImage(const QString& id, QSize* size, const QSize& requestedSize)
+{
+	int slash = id.indexOf('/');
+	if (slash <= 0)
+	{
+		return QImage();
+	}
+	int64_t positionMs = id.left(slash).toLongLong();
+	std::string filePath = QUrl::fromPercentEncoding(id.mid(slash + 1).toUtf8()).toStdString();
+	int width = requestedSize.width() > 0 ? requestedSize.width() : DEFAULT_WIDTH;
+	int64_t step = positionMs / THUMBNAIL_STEP_MS;
+
+	QImage image;
+	SDL_LockMutex(m_mutex);
+	if (filePath != m_filePath)
+	{
+		// ý壬֮ǰĻ治
+		closeSource();
+		m_lru.clear();
+		m_cacheMap.clear();
+		m_cacheBytes = 0;
+		m_stepKeyframes.clear();
+		m_filePath = filePath;
+		openSource(filePath);
+	}
+	int64_t key = m_codecCtx ? keyframeOf(step) : AV_NOPTS_VALUE;
+	if ((key == AV_NOPTS_VALUE || !lookup(key, width, &image)) && m_codecCtx)
+	{
+		// ؼ֪֡ʱֱӽʱǰ
+		AVStream* stream = m_fmtCtx->streams[m_streamIndex];
+		int64_t target = key;
+		if (target == AV_NOPTS_VALUE)
+		{
+			target = step * THUMBNAIL_STEP_MS * 1000;
+			if (stream->start_time != AV_NOPTS_VALUE)
+			{
+				target += av_rescale_q(stream->start_time, stream->time_base, { 1, AV_TIME_BASE });
+			}
+		}
+		int64_t keyframePts = AV_NOPTS_VALUE;
+		image = decodeThumbnail(target, width, &keyframePts);
+		if (!image.isNull() && keyframePts != AV_NOPTS_VALUE)
+		{
+			m_stepKeyframes[step] = keyframePts;
+			insert(keyframePts, image);
+		}
+	}
+	SDL_UnlockMutex(m_mutex);
+
+	if (size)
+	{
+		*size = QSize(image.width(), image.height());
+	}
+	return image;
+}
+
+void ThumbnailProvider::setMemoryBudget(qint64 bytes)
+{
+	SDL_LockMutex(m_mutex);
+	m_memoryBudget = bytes;
+	evict();
+	SDL_UnlockMutex(m_mutex);
+}
+
+double ThumbnailProvider::thumbnailsPerSecond()
+{
+	return m_decodeTime > 0 ? (double)m_decodedCount * AV_TIME_BASE / m_decodeTime : 0;
+}
+
+bool ThumbnailProvider::openSource(const std::string& filePath)
+{
+	int ret = avformat_open_input(&m_fmtCtx, filePath.c_str(), nullptr, nullptr);
+	if (ret >= 0)
+	{
+		ret = avformat_find_stream_info(m_fmtCtx, nullptr);
+	}
+	if (ret >= 0)
+	{
+		ret = av_find_best_stream(m_fmtCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+	}
+	if (ret < 0)
+	{
+		closeSource();
+		return false;
+	}
+	m_streamIndex = ret;
+	// ֻƵİ
+	for (unsigned int i = 0; i < m_fmtCtx->nb_streams; ++i)
+	{
+		m_fmtCtx->streams[i]->discard = (int)i == m_streamIndex ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+	}
+	AVCodecParameters* codecParam = m_fmtCtx->streams[m_streamIndex]->codecpar;
+	const AVCodec* codec = avcodec_find_decoder(codecParam->codec_id);
+	if (!codec)
+	{
+		closeSource();
+		return false;
+	}
+	m_codecCtx = avcodec_alloc_context3(codec);
+	avcodec_parameters_to_context(m_codecCtx, codecParam);
+	// ֻؼ֡߳̽벻ͲCPUؼ֡֡
+	m_codecCtx->skip_frame = AVDISCARD_NONKEY;
+	m_codecCtx->thread_count = 1;
+	if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
+	{
+		closeSource();
+		return false;
+	}
+	m_pkt = av_packet_alloc();
+	m_frame = av_frame_alloc();
+	m_keyframeIndex.open(filePath, m_streamIndex);
+	return true;
+}
+
+void ThumbnailProvider::closeSource()
+{
+	m_keyframeIndex.close();
+	sws_freeContext(m_swsCtx);
+	m_swsCtx = nullptr;
+	av_packet_free(&m_pkt);
+	av_frame_free(&m_frame);
+	avcodec_free_context(&m_codecCtx);
+	avformat_close_input(&m_fmtCtx);
+	m_streamIndex = -1;
+}
+
+int64_t ThumbnailProvider::keyframeOf(int64_t step)
+{
+	auto it = m_stepKeyframes.find(step);
+	if (it != m_stepKeyframes.end())
+	{
+		return it->second;
+	}
+	AVStream* stream = m_fmtCtx->streams[m_streamIndex];
+	int64_t target = step * THUMBNAIL_STEP_MS * 1000;
+	if (stream->start_time != AV_NOPTS_VALUE)
+	{
+		target += av_rescale_q(stream->start_time, stream->time_base, { 1, AV_TIME_BASE });
+	}
+	KeyframeIndex::Entry keyframe;
+	if (!m_keyframeIndex.find(target, &keyframe))
+	{
+		return AV_NOPTS_VALUE;
+	}
+	m_stepKeyframes[step] = keyframe.pts;
+	return keyframe.pts;
+}
+
+QImage ThumbnailProvider::decodeThumbnail(int64_t target, int width, int64_t* keyframePts)
+{
+	int64_t start = av_gettime_relative();
+	AVStream* stream = m_fmtCtx->streams[m_streamIndex];
+	// ȡĹؼ֡䵽max_ts֮
+	target = av_rescale_q_rnd(target, { 1, AV_TIME_BASE }, stream->time_base, AV_ROUND_UP);
+	// ȡĿ֮ǰĹؼ֡
+	if (avformat_seek_file(m_fmtCtx, m_streamIndex, INT64_MIN, target, target, 0) < 0)
+	{
+		return QImage();
+	}
+	avcodec_flush_buffers(m_codecCtx);
+
+	bool bGot = false;
+	for (int i = 0; i < MAX_READ_PACKETS && !bGot; ++i)
+	{
+		int ret = av_read_frame(m_fmtCtx, m_pkt);
+		// ʱͿհȡʣ֡
+		avcodec_send_packet(m_codecCtx, ret < 0 ? nullptr : m_pkt);
+		av_packet_unref(m_pkt);
+		bGot = avcodec_receive_frame(m_codecCtx, m_frame) == 0;
+		if (ret < 0)
+		{
+			break;
+		}
+	}
+	if (!bGot)
+	{
+		return QImage();
+	}
+	// KeyframeIndexĵλһ£ǰͬһ֡ͬһ
+	int64_t pts = m_frame->pts != AV_NOPTS_VALUE ? m_frame->pts : m_frame->best_effort_timestamp;
+	*keyframePts = pts != AV_NOPTS_VALUE ? av_rescale_q(pts, stream->time_base, { 1, AV_TIME_BASE }) : AV_NOPTS_VALUE;
+
+	// ʾ߱ţ˫Լ
+	AVRational sar = m_frame->sample_aspect_ratio.num > 0 ? m_frame->sample_aspect_ratio : AVRational{ 1, 1 };
+	int height = (int)av_rescale(width, (int64_t)m_frame->height * sar.den, (int64_t)m_frame->width * sar.num);
+	height = FFMAX(height & ~1, 2);
+	m_swsCtx = sws_getCachedContext(m_swsCtx,
+		m_frame->width, m_frame->height, (AVPixelFormat)m_frame->format,
+		width, height, AV_PIX_FMT_RGB32,
+		SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+	QImage image;
+	if (m_swsCtx)
+	{
+		image = QImage(width, height, QImage::Format_RGB32);
+		uint8_t* dst[4] = { image.bits() };
+		int dstLinesize[4] = { image.bytesPerLine() };
+		sws_scale(m_swsCtx, m_frame->data, m_frame->linesize, 0, m_frame->height, dst, dstLinesize);
+	}
+	av_frame_unref(m_frame);
+
+	m_decodeTime += av_gettime_relative() - start;
+	if (++m_decodedCount % REPORT_INTERVAL == 0)
+	{
+		std::cout << "[thumbnail]: " << m_decodedCount << " decoded, " << thumbnailsPerSecond() << "/s" << std::endl;
+	}
+	return image;
+}
+
+bool ThumbnailProvider::lookup(int64_t key, int width, QImage* image)
+{
+	auto it = m_cacheMap.find(key);
+	// ĳߴ
+	if (it == m_cacheMap.end() || it->second->image.width() != width)
+	{
+		return false;
+	}
+	m_lru.splice(m_lru.begin(), m_lru, it->second);
+	*image = it->second->image;
+	return true;
+}
+
+void ThumbnailProvider::insert(int64_t key, const QImage& image)
+{
+	auto it = m_cacheMap.find(key);
+	if (it != m_cacheMap.end())
+	{
+		m_cacheBytes -= imageBytes(it->second->image);
+		m_lru.erase(it->second);
+	}
+	m_lru.push_front({ key, image });
+	m_cacheMap[key] = m_lru.begin();
+	m_cacheBytes += imageBytes(image);
+	evict();
+}
+
+void ThumbnailProvider::evict()
+{
+	while (m_cacheBytes > m_memoryBudget && !m_lru.empty())
+	{
+		m_cacheBytes -= imageBytes(m_lru.back().image);
+		m_cacheMap.erase(m_lru.back().key);
+		m_lru.pop_back();
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <list>
+#include <unordered_map>
+
+#include <QQuickImageProvider>
+#include <QImage>
+
+#include "KeyframeIndex.h"
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+#include "libavutil/avutil.h"
+#include "libavutil/time.h"
+#include "libswscale/swscale.h"
+#include "SDL2/SDL.h"
+}
+
+// ԤͼQML"image://thumbnail//ý·"
+// ʹöAVFormatContextֻؼ֡QMLͼƬִ߳УDecoderκζк
+// 水Ĺؼ֡ptsţͬһGOPһ
+class ThumbnailProvider : public QQuickImageProvider
+{
+public:
+	ThumbnailProvider();
+	~ThumbnailProvider();
+
+	QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override;
+
+	void setMemoryBudget(qint64 bytes); // ޣʱ̭δõ
+	double thumbnailsPerSecond(); // ʵʽͼʱ
+
+private:
+	struct CacheEntry
+	{
+		int64_t key; // ؼ֡ptsAV_TIME_BASE
+		QImage image;
+	};
+
+	bool openSource(const std::string& filePath);
+	void closeSource();
+	int64_t keyframeOf(int64_t step); // GOPĹؼ֡ptsδ֪ʱAV_NOPTS_VALUE
+	QImage decodeThumbnail(int64_t target, int width, int64_t* keyframePts); // targetΪAV_TIME_BASEʱ
+	bool lookup(int64_t key, int width, QImage* image);
+	void insert(int64_t key, const QImage& image);
+	void evict();
+
+	SDL_mutex* m_mutex = nullptr; // ͼƬ߳̿ܲ󣬽ͻ涼
+
+	std::string m_filePath;
+	AVFormatContext* m_fmtCtx = nullptr;
+	AVCodecContext* m_codecCtx = nullptr;
+	SwsContext* m_swsCtx = nullptr;
+	AVPacket* m_pkt = nullptr;
+	AVFrame* m_frame = nullptr;
+	int m_streamIndex = -1;
+	KeyframeIndex m_keyframeIndex; // Decoder·ļǰ֡¼ӳ
+	std::unordered_map<int64_t, int64_t> m_stepKeyframes; // ʱ̰THUMBNAIL_STEP_MSȡ -> ؼ֡pts
+
+	std::list<CacheEntry> m_lru; // ʹõǰ
+	std::unordered_map<int64_t, std::list<CacheEntry>::iterator> m_cacheMap;
+	qint64 m_cacheBytes = 0;
+	qint64 m_memoryBudget = 32 * 1024 * 1024;
+
+	qint64 m_decodedCount = 0;
+	int64_t m_decodeTime = 0; // ΢
+
+	const int64_t THUMBNAIL_STEP_MS = 1000; // ͬһڵֻһιؼ֡
+	const int DEFAULT_WIDTH = 160;
+	const int MAX_READ_PACKETS = 512; // Ҳؼ֡ʱ
+	const int REPORT_INTERVAL = 100; // ÿôŴӡһ
+};
@@ -3,6 +3,7 @@
 
 #include "Decoder.h"
 #include "AudioOutput.h"
+#include "ThumbnailProvider.h"
 
 int main(int argc, char *argv[])
 {
@@ -15,6 +16,7 @@ int main(int argc, char *argv[])
     qmlRegisterType<Decoder>("Decoder", 1, 0, "Decoder");
     qmlRegisterType<AudioOutput>("AudioOutput", 1, 0, "AudioOutput");
     QQmlApplicationEngine engine;
+    engine.addImageProvider(QStringLiteral("thumbnail"), new ThumbnailProvider);
     engine.load(QUrl(QStringLiteral("qrc:/main.qml")));
     if (engine.rootObjects().isEmpty())
         return -1;
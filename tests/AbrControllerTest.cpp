@@ -0,0 +1,152 @@
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "TestUtil.h"
+#include "AbrController.h"
+
+// AbrControllerƺѡֹAVFormatContextģhlsvariantҪ
+
+// variantÿһ·Ƶһ·Ƶʹ
+struct FakeHls
+{
+	AVFormatContext fmtCtx = {};
+	AVProgram programs[3] = {};
+	AVProgram* programList[3];
+	AVStream streams[6] = {};
+	AVStream* streamList[6];
+	AVCodecParameters params[6] = {};
+	unsigned int streamIndexes[3][2];
+
+	FakeHls()
+	{
+		const int64_t bandwidths[] = { 4000000, 1000000, 2000000 };
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 2; ++j)
+			{
+				int inx = i * 2 + j;
+				params[inx].codec_type = j == 0 ? AVMEDIA_TYPE_VIDEO : AVMEDIA_TYPE_AUDIO;
+				streams[inx].codecpar = &params[inx];
+				streamList[inx] = &streams[inx];
+				streamIndexes[i][j] = inx;
+			}
+			av_dict_set(&programs[i].metadata, "variant_bitrate", std::to_string(bandwidths[i]).c_str(), 0);
+			programs[i].stream_index = streamIndexes[i];
+			programs[i].nb_stream_indexes = 2;
+			programList[i] = &programs[i];
+		}
+		fmtCtx.programs = programList;
+		fmtCtx.nb_programs = 3;
+		fmtCtx.streams = streamList;
+		fmtCtx.nb_streams = 6;
+	}
+	~FakeHls()
+	{
+		for (AVProgram& program : programs)
+		{
+			av_dict_free(&program.metadata);
+		}
+	}
+};
+
+// bpsٶcountsecondsķƬ
+static void feed(AbrController& abr, int64_t bps, double seconds, int count)
+{
+	static int64_t busyClock = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		int key = 0;
+		abr.segmentOpened(&key, busyClock);
+		busyClock += (int64_t)(seconds * AV_TIME_BASE);
+		abr.segmentClosed(&key, (int64_t)(bps * seconds / 8), busyClock);
+	}
+}
+
+static bool near(int64_t value, int64_t expected)
+{
+	return std::llabs(value - expected) <= expected / 100;
+}
+
+static void testInitSortsVariants()
+{
+	FakeHls hls;
+	AbrController abr;
+	CHECK(abr.init(&hls.fmtCtx));
+	CHECK(abr.variantCount() == 3);
+	CHECK(abr.variant(0).bandwidth == 1000000 && abr.variant(0).programIndex == 1);
+	CHECK(abr.variant(2).bandwidth == 4000000 && abr.variant(2).videoIndex == 0 && abr.variant(2).audioIndex == 1);
+	// ֻǰлĿ
+	abr.applyDiscard(&hls.fmtCtx, 0, -1);
+	CHECK(hls.programs[1].discard == AVDISCARD_DEFAULT && hls.programs[0].discard == AVDISCARD_ALL);
+	CHECK(hls.streams[2].discard == AVDISCARD_DEFAULT && hls.streams[3].discard == AVDISCARD_DEFAULT);
+	CHECK(hls.streams[0].discard == AVDISCARD_ALL && hls.streams[5].discard == AVDISCARD_ALL);
+}
+
+static void testEstimate()
+{
+	AbrController abr;
+	// 㡢̫Сδ򿪵ķƬ
+	feed(abr, 3000000, 1.0, 1);
+	CHECK(abr.estimate() == 0);
+	int key = 0;
+	abr.segmentOpened(&key, 0);
+	abr.segmentClosed(&key, 1000, AV_TIME_BASE);
+	abr.segmentClosed(&key, 1000000, AV_TIME_BASE);
+	CHECK(abr.estimate() == 0);
+	// ٶȺ㶨ʱƫʵٶ
+	feed(abr, 3000000, 1.0, 1);
+	CHECK(near(abr.estimate(), 3000000));
+	CHECK(abr.bandwidth() == abr.estimate());
+	// ½ʱٸ棬ʱȡһ·
+	feed(abr, 1000000, 2.0, 2);
+	CHECK(abr.estimate() < 2000000);
+	int64_t low = abr.estimate();
+	feed(abr, 10000000, 1.0, 1);
+	CHECK(abr.estimate() < 10000000 / 2);
+	CHECK(abr.estimate() > low);
+}
+
+static void testSelect()
+{
+	FakeHls hls;
+	AbrController abr;
+	CHECK(abr.init(&hls.fmtCtx));
+	int64_t now = 100 * AV_TIME_BASE;
+	CHECK(abr.select(0, now) == -1); // ûйʱѡ
+
+	// 3M80%ֻ2M
+	feed(abr, 3000000, 20.0, 5);
+	CHECK(abr.select(0, now) == 1);
+	abr.setCurrent(1, now);
+
+	// 㹻ʣ岻ϴл̫ʱ
+	feed(abr, 10000000, 20.0, 5);
+	CHECK(abr.select(2 * AV_TIME_BASE, now + 10 * AV_TIME_BASE) == 1);
+	CHECK(abr.select(6 * AV_TIME_BASE, now + AV_TIME_BASE) == 1);
+	CHECK(abr.select(6 * AV_TIME_BASE, now + 10 * AV_TIME_BASE) == 2);
+	now += 10 * AV_TIME_BASE;
+	abr.setCurrent(2, now);
+
+	// ½ʱݲʱܳܵ
+	feed(abr, 1500000, 20.0, 5);
+	CHECK(abr.select(10 * AV_TIME_BASE, now + AV_TIME_BASE) == 2);
+	CHECK(abr.select(2 * AV_TIME_BASE, now + AV_TIME_BASE) == 0);
+	abr.setCurrent(0, now + AV_TIME_BASE);
+	CHECK(abr.upSwitches() == 1 && abr.downSwitches() == 1 && abr.switches() == 2);
+
+	// ƽʰýʱȨ
+	abr.addMedia(3 * AV_TIME_BASE);
+	abr.setCurrent(2, now + 20 * AV_TIME_BASE);
+	abr.addMedia(AV_TIME_BASE);
+	CHECK(abr.averageBitrate() == (3 * 1000000 + 4000000) / 4);
+}
+
+int main()
+{
+	testInitSortsVariants();
+	testEstimate();
+	testSelect();
+	std::cout << "AbrControllerTest passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,170 @@
+#include <vector>
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include "TestUtil.h"
+#include "MediaQueue.h"
+
+// AudioRingBufferдflushд룬ҪQtýļ
+
+static const size_t CAPACITY = 1024;
+static const int BYTES_PER_SEC = 4000; // ÿֽ250us˶ʱ
+
+static void writeBytes(AudioRingBuffer& ring, uint8_t value, size_t n, int64_t pts)
+{
+	std::vector<uint8_t> buf(n, value);
+	ring.write(buf.data(), n, pts);
+}
+
+static bool allEqual(const std::vector<uint8_t>& buf, size_t from, size_t to, uint8_t value)
+{
+	for (size_t i = from; i < to; ++i)
+	{
+		if (buf[i] != value)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void testWrapAround()
+{
+	AudioRingBuffer ring;
+	ring.init(CAPACITY, BYTES_PER_SEC);
+	writeBytes(ring, 1, 768, 0);
+	std::vector<uint8_t> out(CAPACITY);
+	int64_t clock = AV_NOPTS_VALUE;
+	CHECK(ring.read(out.data(), 512, &clock) == 512);
+	CHECK(clock == 0);
+	// βֻʣ256ֽڣд
+	writeBytes(ring, 2, 512, 192000);
+	CHECK(ring.size() == 768);
+	CHECK(ring.read(out.data(), CAPACITY, &clock) == 768);
+	CHECK(clock == 512 * AV_TIME_BASE / BYTES_PER_SEC);
+	CHECK(allEqual(out, 0, 256, 1));
+	CHECK(allEqual(out, 256, 768, 2));
+	CHECK(ring.size() == 0);
+}
+
+static void testFlushFull()
+{
+	AudioRingBuffer ring;
+	ring.init(CAPACITY, BYTES_PER_SEC);
+	writeBytes(ring, 1, CAPACITY, 0);
+	CHECK(!ring.writable(1));
+	// seek߶У֮ûʱȡҲҪóռ
+	ring.flush();
+	std::vector<uint8_t> out(CAPACITY);
+	int64_t clock = AV_NOPTS_VALUE;
+	CHECK(ring.read(out.data(), CAPACITY, &clock) == 0);
+	CHECK(clock == AV_NOPTS_VALUE);
+	CHECK(ring.size() == 0); // playAudioEofݴжϲ
+	CHECK(ring.writable(CAPACITY));
+	writeBytes(ring, 3, 256, 5 * AV_TIME_BASE);
+	CHECK(ring.read(out.data(), CAPACITY, &clock) == 256);
+	CHECK(clock == 5 * AV_TIME_BASE);
+	CHECK(allEqual(out, 0, 256, 3));
+}
+
+static void testFlushPartlyRead()
+{
+	AudioRingBuffer ring;
+	ring.init(CAPACITY, BYTES_PER_SEC);
+	writeBytes(ring, 1, CAPACITY, 0);
+	std::vector<uint8_t> out(CAPACITY);
+	CHECK(ring.read(out.data(), 100, nullptr) == 100);
+	ring.flush();
+	writeBytes(ring, 2, 64, AV_TIME_BASE);
+	// flush֮ǰ924ֽڲ
+	int64_t clock = AV_NOPTS_VALUE;
+	CHECK(ring.read(out.data(), CAPACITY, &clock) == 64);
+	CHECK(clock == AV_TIME_BASE);
+	CHECK(allEqual(out, 0, 64, 2));
+}
+
+static void testFlushWakesProducer()
+{
+	AudioRingBuffer ring;
+	ring.init(CAPACITY, BYTES_PER_SEC);
+	writeBytes(ring, 1, CAPACITY, 0);
+	// ̴߳seekʱflushλд룬ʱwaitWritable
+	std::future<bool> producer = std::async(std::launch::async, [&ring] {
+		ring.flush();
+		if (!ring.waitWritable(CAPACITY / 2))
+		{
+			return false;
+		}
+		writeBytes(ring, 2, CAPACITY / 2, AV_TIME_BASE);
+		return true;
+	});
+	// Ƶصȡûʱ
+	std::vector<uint8_t> out(CAPACITY);
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+	while (producer.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready &&
+		std::chrono::steady_clock::now() < deadline)
+	{
+		ring.read(out.data(), 64, nullptr);
+	}
+	CHECK(producer.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+	CHECK(producer.get());
+	CHECK(ring.size() <= CAPACITY / 2);
+	ring.abort();
+}
+
+static void testLiveCatchUp()
+{
+	AudioRingBuffer ring;
+	ring.init(CAPACITY, BYTES_PER_SEC);
+	std::vector<uint8_t> out(CAPACITY);
+	int64_t clock = AV_NOPTS_VALUE;
+	for (int round = 1; round <= 3; ++round)
+	{
+		// ֱѹд߳waitWritable
+		writeBytes(ring, 1, ring.capacity - ring.size(), round * AV_TIME_BASE);
+		std::promise<void> blocked;
+		std::future<bool> producer = std::async(std::launch::async, [&ring, &blocked, round] {
+			blocked.set_value();
+			if (ring.waitWritable(CAPACITY / 2))
+			{
+				return false; // û߶ȡֻܱ
+			}
+			// ׷ϣѹݣĿ֮д
+			ring.flush();
+			if (!ring.waitWritable(CAPACITY / 2))
+			{
+				return false;
+			}
+			writeBytes(ring, (uint8_t)(10 + round), CAPACITY / 2, round * 10 * AV_TIME_BASE);
+			return true;
+		});
+		blocked.get_future().wait();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		ring.interrupt(); // eventLoop׷
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+		while (producer.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready &&
+			std::chrono::steady_clock::now() < deadline)
+		{
+			ring.read(out.data(), 0, nullptr); // ֻflushݣ˶
+		}
+		CHECK(producer.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+		CHECK(producer.get());
+		// ѹݲٲʱ׷Ϻλ
+		CHECK(ring.read(out.data(), CAPACITY, &clock) == CAPACITY / 2);
+		CHECK(clock == round * 10 * AV_TIME_BASE);
+		CHECK(allEqual(out, 0, CAPACITY / 2, (uint8_t)(10 + round)));
+		CHECK(ring.size() == 0);
+	}
+}
+
+int main()
+{
+	testWrapAround();
+	testFlushFull();
+	testFlushPartlyRead();
+	testFlushWakesProducer();
+	testLiveCatchUp();
+	std::cout << "AudioRingBufferTest passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,106 @@
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <memory>
+
+#include "TestUtil.h"
+#include "DecodeScheduler.h"
+
+// DecodeSchedulerBUSY/IDLE/DONEȣֻwakeִУڹ߳ʱȫ
+
+typedef DecodeScheduler::TaskState TaskState;
+
+// ڳʱڳtrue
+template<class Pred>
+static bool waitUntil(Pred pred, int timeoutMs = 5000)
+{
+	for (int i = 0; i < timeoutMs && !pred(); ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return pred();
+}
+
+static void testBusyUntilDone()
+{
+	DecodeScheduler* scheduler = DecodeScheduler::instance();
+	std::atomic<int> steps{ 0 };
+	DecodeScheduler::Task* task = scheduler->submit([&steps] {
+		return ++steps < 100 ? TaskState::BUSY : TaskState::DONE;
+	}, DecodeScheduler::Priority::NORMAL);
+	scheduler->wait(task);
+	CHECK(steps == 100);
+}
+
+static void testIdleRunsOnlyAfterWake()
+{
+	DecodeScheduler* scheduler = DecodeScheduler::instance();
+	std::atomic<int> runs{ 0 };
+	std::atomic<bool> bReady{ false };
+	DecodeScheduler::Task* task = scheduler->submit([&runs, &bReady] {
+		runs++;
+		return bReady ? TaskState::DONE : TaskState::IDLE;
+	}, DecodeScheduler::Priority::NORMAL);
+	CHECK(waitUntil([&runs] { return runs == 1; }));
+	// ûлʱֹ𣬲ת
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(runs == 1);
+	scheduler->wake(task);
+	CHECK(waitUntil([&runs] { return runs == 2; }));
+	bReady = true;
+	scheduler->wait(task);
+	CHECK(runs == 3);
+}
+
+static void testWakeDuringRun()
+{
+	DecodeScheduler* scheduler = DecodeScheduler::instance();
+	std::atomic<int> runs{ 0 };
+	DecodeScheduler::Task* task = scheduler->submit([&runs] {
+		if (++runs == 1)
+		{
+			// ִڼ䱻ѣIDLEӦµ
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			return TaskState::IDLE;
+		}
+		return TaskState::DONE;
+	}, DecodeScheduler::Priority::NORMAL);
+	CHECK(waitUntil([&runs] { return runs == 1; }));
+	scheduler->wake(task);
+	CHECK(waitUntil([&runs] { return runs == 2; }));
+	scheduler->wait(task);
+}
+
+static void testMoreTasksThanWorkers()
+{
+	DecodeScheduler* scheduler = DecodeScheduler::instance();
+	const int taskNum = scheduler->workerCount() * 4;
+	const int stepNum = 200;
+	std::atomic<int> steps{ 0 };
+	std::vector<DecodeScheduler::Task*> tasks;
+	for (int i = 0; i < taskNum; ++i)
+	{
+		auto prio = i % 2 ? DecodeScheduler::Priority::HIGH : DecodeScheduler::Priority::NORMAL;
+		std::shared_ptr<int> left = std::make_shared<int>(stepNum);
+		tasks.push_back(scheduler->submit([&steps, left] {
+			steps++;
+			return --*left > 0 ? TaskState::BUSY : TaskState::DONE;
+		}, prio));
+	}
+	for (DecodeScheduler::Task* task : tasks)
+	{
+		scheduler->wait(task);
+	}
+	CHECK(steps == taskNum * stepNum);
+}
+
+int main()
+{
+	testBusyUntilDone();
+	testIdleRunsOnlyAfterWake();
+	testWakeDuringRun();
+	testMoreTasksThanWorkers();
+	std::cout << "DecodeSchedulerTest passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include <sys/stat.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "TestUtil.h"
+#include "KeyframeIndex.h"
+
+// KeyframeIndex·ļptsң·ļýļƥʱ
+// ýļֻڣݲý壬ɨ̻߳ʧ
+
+static const char* MEDIA_PATH = "KeyframeIndexTest.bin";
+
+// KeyframeIndex.cppе·ļͷһ
+struct SidecarHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	int64_t fileSize;
+	int64_t mtime;
+	int32_t streamIndex;
+	uint32_t count;
+};
+
+static void writeFile(const std::string& path, const void* data, size_t size)
+{
+	FILE* fp = fopen(path.c_str(), "wb");
+	CHECK(fp);
+	CHECK(fwrite(data, 1, size, fp) == size);
+	fclose(fp);
+}
+
+// ÿһؼ֡һ1
+static void writeSidecar(int64_t fileSizeDelta)
+{
+	struct stat st;
+	CHECK(stat(MEDIA_PATH, &st) == 0);
+	std::vector<KeyframeIndex::Entry> entries;
+	for (int i = 1; i <= 5; ++i)
+	{
+		entries.push_back({ i * (int64_t)AV_TIME_BASE, i * 1000, 100, 0 });
+	}
+	SidecarHeader header = { 0x49464b50, 1, (int64_t)st.st_size + fileSizeDelta, (int64_t)st.st_mtime, 0, (uint32_t)entries.size() };
+	std::vector<char> data((const char*)&header, (const char*)&header + sizeof(header));
+	data.insert(data.end(), (const char*)entries.data(), (const char*)(entries.data() + entries.size()));
+	writeFile(std::string(MEDIA_PATH) + ".kfidx", data.data(), data.size());
+}
+
+static void testFind()
+{
+	writeSidecar(0);
+	KeyframeIndex index;
+	index.open(MEDIA_PATH, 0);
+	CHECK(index.isReady());
+	CHECK(index.size() == 5);
+	KeyframeIndex::Entry entry;
+	// һؼ֮֡ǰûпõ
+	CHECK(!index.find(AV_TIME_BASE - 1, &entry));
+	CHECK(index.find(AV_TIME_BASE, &entry) && entry.pos == 1000);
+	CHECK(index.find(3 * AV_TIME_BASE - 1, &entry) && entry.pos == 2000);
+	CHECK(index.find(3 * AV_TIME_BASE, &entry) && entry.pos == 3000);
+	CHECK(index.find(100 * AV_TIME_BASE, &entry) && entry.pos == 5000);
+	index.close();
+	CHECK(!index.isReady() && !index.find(3 * AV_TIME_BASE, &entry));
+}
+
+static void testStaleSidecar()
+{
+	// ýļСˣ·ļϣɨʧܣһֱ
+	writeSidecar(1);
+	KeyframeIndex index;
+	index.open(MEDIA_PATH, 0);
+	index.close();
+	KeyframeIndex::Entry entry;
+	CHECK(!index.isReady() && !index.find(3 * AV_TIME_BASE, &entry));
+}
+
+int main()
+{
+	const char media[] = "not a media file";
+	writeFile(MEDIA_PATH, media, sizeof(media));
+	testFind();
+	testStaleSidecar();
+	remove((std::string(MEDIA_PATH) + ".kfidx").c_str());
+	remove(MEDIA_PATH);
+	std::cout << "KeyframeIndexTest passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,166 @@
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include "TestUtil.h"
+#include "MediaQueue.h"
+
+// PacketQueue˳serialǺabortֻpts˶
+
+static void pushPts(PacketQueue& queue, int64_t pts, int serial = 0)
+{
+	AVPacket* pkt = av_packet_alloc();
+	pkt->pts = pts;
+	CHECK(queue.push(pkt, serial) == QueueState::NORMAL);
+	av_packet_free(&pkt);
+}
+
+static void testOrderAndCapacity()
+{
+	PacketPool pool;
+	PacketQueue queue(3, pool); // ȡ4
+	CHECK(queue.capacity == 4);
+	for (int i = 0; i < 4; ++i)
+	{
+		pushPts(queue, i);
+	}
+	// ʱȡ
+	AVPacket* pkt = av_packet_alloc();
+	pkt->pts = 100;
+	CHECK(queue.push(pkt) == QueueState::FULL);
+	CHECK(pkt->pts == 100);
+	CHECK(queue.size() == 4);
+	for (int i = 0; i < 4; ++i)
+	{
+		CHECK(queue.pop(pkt) == QueueState::NORMAL);
+		CHECK(pkt->pts == i);
+	}
+	CHECK(queue.pop(pkt) == QueueState::EMPTY);
+	// ƺ԰˳
+	for (int i = 0; i < 6; ++i)
+	{
+		pushPts(queue, 10 + i);
+		CHECK(queue.pop(pkt) == QueueState::NORMAL);
+		CHECK(pkt->pts == 10 + i);
+	}
+	av_packet_free(&pkt);
+}
+
+static void testBatchStopsAtSerial()
+{
+	PacketPool pool;
+	PacketQueue queue(8, pool);
+	pushPts(queue, 0, 1);
+	pushPts(queue, 1, 1);
+	pushPts(queue, 2, 2);
+	pushPts(queue, 3, 2);
+	AVPacket* pkts[4];
+	for (AVPacket*& pkt : pkts)
+	{
+		pkt = av_packet_alloc();
+	}
+	size_t count = 0;
+	int serial = 0;
+	CHECK(queue.popBatch(pkts, 4, &count, &serial) == QueueState::NORMAL);
+	CHECK(count == 2 && serial == 1);
+	CHECK(pkts[0]->pts == 0 && pkts[1]->pts == 1);
+	CHECK(queue.popBatch(pkts, 4, &count, &serial) == QueueState::NORMAL);
+	CHECK(count == 2 && serial == 2);
+	CHECK(pkts[0]->pts == 2 && pkts[1]->pts == 3);
+	for (AVPacket*& pkt : pkts)
+	{
+		av_packet_free(&pkt);
+	}
+}
+
+static void testLastMarker()
+{
+	PacketPool pool;
+	PacketQueue queue(8, pool);
+	pushPts(queue, 0);
+	CHECK(queue.push(nullptr) == QueueState::NORMAL);
+	pushPts(queue, 1);
+	AVPacket* pkts[4];
+	for (AVPacket*& pkt : pkts)
+	{
+		pkt = av_packet_alloc();
+	}
+	// ֮ǰİͱһȡ֮һ
+	size_t count = 0;
+	CHECK(queue.popBatch(pkts, 4, &count) == QueueState::LAST);
+	CHECK(count == 1 && pkts[0]->pts == 0);
+	CHECK(queue.popBatch(pkts, 4, &count) == QueueState::NORMAL);
+	CHECK(count == 1 && pkts[0]->pts == 1);
+	for (AVPacket*& pkt : pkts)
+	{
+		av_packet_free(&pkt);
+	}
+}
+
+static void testWaitAndAbort()
+{
+	PacketPool pool;
+	PacketQueue queue(2, pool);
+	// а
+	std::future<int64_t> consumer = std::async(std::launch::async, [&queue] {
+		AVPacket* pkt = av_packet_alloc();
+		CHECK(queue.waitPop(pkt) == QueueState::NORMAL);
+		int64_t pts = pkt->pts;
+		av_packet_free(&pkt);
+		return pts;
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	CHECK(consumer.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+	pushPts(queue, 7);
+	CHECK(consumer.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+	CHECK(consumer.get() == 7);
+
+	// ϣabort󷵻FULL
+	pushPts(queue, 0);
+	pushPts(queue, 1);
+	std::future<QueueState> producer = std::async(std::launch::async, [&queue] {
+		AVPacket* pkt = av_packet_alloc();
+		pkt->pts = 2;
+		QueueState state = queue.waitPush(pkt);
+		av_packet_free(&pkt);
+		return state;
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	CHECK(producer.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+	queue.abort();
+	CHECK(producer.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+	CHECK(producer.get() == QueueState::FULL);
+
+	// resetʣİԼʹ
+	queue.reset();
+	CHECK(queue.size() == 0);
+	pushPts(queue, 3);
+	AVPacket* pkt = av_packet_alloc();
+	CHECK(queue.pop(pkt) == QueueState::NORMAL);
+	CHECK(pkt->pts == 3);
+	av_packet_free(&pkt);
+}
+
+static void testPoolReuse()
+{
+	PacketPool pool;
+	{
+		PacketQueue queue(4, pool);
+	}
+	CHECK(pool.allocCount == 4 && pool.reuseCount == 0);
+	{
+		PacketQueue queue(4, pool);
+	}
+	CHECK(pool.allocCount == 4 && pool.reuseCount == 4);
+}
+
+int main()
+{
+	testOrderAndCapacity();
+	testBatchStopsAtSerial();
+	testLastMarker();
+	testWaitAndAbort();
+	testPoolReuse();
+	std::cout << "PacketQueueTest passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <iostream>
+#include <cstdlib>
+
+// ʱӡλò˳ctestֵж
+#define CHECK(cond) \
+	do \
+	{ \
+		if (!(cond)) \
+		{ \
+			std::cout << __FILE__ << ":" << __LINE__ << ": CHECK(" << #cond << ") failed" << std::endl; \
+			std::exit(1); \
+		} \
+	} while (0)